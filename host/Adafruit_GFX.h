@@ -0,0 +1,50 @@
+/**
+ * Host shim for Adafruit GFX
+ *
+ * Rasterizes the primitives the firmware uses into a 1bpp buffer so the
+ * host build draws the same pixels. Text only advances the cursor.
+ */
+
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print {
+  public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { drawLine(x, y, x + w - 1, y, color); }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { drawLine(x, y, x, y + h - 1, color); }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextColor(uint16_t c) { (void)c; }
+    void setTextColor(uint16_t c, uint16_t bg) { (void)c; (void)bg; }
+    void setTextSize(uint8_t s) { textSize = s; }
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+  protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t cursorX = 0;
+    int16_t cursorY = 0;
+    uint8_t textSize = 1;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * Host shim for the Adafruit SSD1306 driver
+ *
+ * Keeps a 128x64 1bpp frame buffer in the same page layout as the panel.
+ * display() counts flushes and can charge a simulated I2C transfer time
+ * to the virtual clock.
+ */
+
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_SETCONTRAST 0x81
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+  public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst = -1);
+
+    bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0x3C);
+    void display();
+    void clearDisplay();
+    void dim(bool dim) { dimmed = dim; }
+    void ssd1306_command(uint8_t c);
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y) const;
+    uint8_t* getBuffer() { return buffer; }
+
+    // Host-only instrumentation
+    unsigned long flushCount = 0;
+    unsigned long flushMicros = 0;  // Virtual time charged per display()
+    bool panelOn = true;
+    bool dimmed = false;
+
+  private:
+    uint8_t buffer[128 * 64 / 8];
+};
+
+#endif
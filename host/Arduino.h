@@ -0,0 +1,140 @@
+/**
+ * Host shim for the Arduino core API
+ *
+ * Lets the firmware sources compile and run on Linux. Time comes from a
+ * virtual clock that the host program advances explicitly, and button
+ * pins read from a table the host program writes.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+
+#define PROGMEM
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// As in the ESP8266 core: typed std::min/max, so mixed-type calls fail
+// to compile here just as they would on the device
+using std::min;
+using std::max;
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper*>(str))
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+
+namespace host {
+  // Virtual clock in microseconds, advanced by the host program; atomic
+  // so benchmarks can run the sketch's parts on several threads
+  extern std::atomic<uint64_t> clockMicros;
+  void advanceMicros(uint64_t us);
+  void advanceMillis(unsigned long ms);
+  
+  // Called after every clock advance (timer callbacks, see Ticker.h)
+  extern void (*clockHook)();
+
+  // Pin levels seen by digitalRead, written by digitalWrite
+  extern uint8_t pinLevels[32];
+
+  // Serial plumbing
+  extern bool serialEcho;
+  void serialFeed(const char* text);
+}
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+char* dtostrf(double value, signed char width, unsigned char prec, char* buf);
+char* itoa(int value, char* buf, int base);
+char* utoa(unsigned value, char* buf, int base);
+char* ultoa(unsigned long value, char* buf, int base);
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+
+    size_t print(const __FlashStringHelper* str) { return write((const char*)str); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = 10) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(T value, int arg) { size_t n = print(value, arg); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    int available();
+    int read();
+    int peek();
+    int availableForWrite() { return 128; }
+    void flush() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+  public:
+    uint32_t getCycleCount();
+    uint32_t getFreeHeap() { return 40000; }
+    uint32_t getCpuFreqMHz() { return 80; }
+};
+
+extern EspClass ESP;
+
+#endif
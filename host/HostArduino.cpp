@@ -0,0 +1,130 @@
+/**
+ * Host shim implementation
+ */
+
+#include "Arduino.h"
+#include <string>
+
+namespace host {
+  std::atomic<uint64_t> clockMicros(0);
+  uint8_t pinLevels[32];
+  bool serialEcho = false;
+  static std::string serialInput;
+
+  void (*clockHook)() = NULL;
+  
+  void advanceMicros(uint64_t us) {
+    clockMicros += us;
+    if (clockHook) clockHook();
+  }
+  void advanceMillis(unsigned long ms) { advanceMicros((uint64_t)ms * 1000); }
+  void serialFeed(const char* text) { serialInput += text; }
+
+  static struct PinInit {
+    PinInit() { memset(pinLevels, HIGH, sizeof(pinLevels)); }
+  } pinInit;
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+int digitalRead(uint8_t pin) { return pin < 32 ? host::pinLevels[pin] : LOW; }
+void digitalWrite(uint8_t pin, uint8_t value) { if (pin < 32) host::pinLevels[pin] = value; }
+unsigned long millis() { return (unsigned long)(host::clockMicros / 1000); }
+unsigned long micros() { return (unsigned long)host::clockMicros; }
+void delay(unsigned long ms) { host::advanceMillis(ms); }
+void delayMicroseconds(unsigned int us) { host::advanceMicros(us); }
+void yield() {}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+  (void)frequency; (void)duration;
+  digitalWrite(pin, HIGH);
+}
+void noTone(uint8_t pin) { digitalWrite(pin, LOW); }
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) { (void)interrupt; (void)isr; (void)mode; }
+void detachInterrupt(int interrupt) { (void)interrupt; }
+
+static uint32_t hostRandomState = 1;
+void randomSeed(unsigned long seed) { hostRandomState = seed ? seed : 1; }
+long random(long howBig) {
+  if (howBig <= 0) return 0;
+  hostRandomState = hostRandomState * 1103515245u + 12345u;
+  return (long)((hostRandomState >> 8) % (uint32_t)howBig);
+}
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) return howSmall;
+  return howSmall + random(howBig - howSmall);
+}
+
+char* dtostrf(double value, signed char width, unsigned char prec, char* buf) {
+  sprintf(buf, "%*.*f", width, prec, value);
+  return buf;
+}
+
+char* itoa(int value, char* buf, int base) {
+  if (base == 16) sprintf(buf, "%x", value);
+  else sprintf(buf, "%d", value);
+  return buf;
+}
+
+char* utoa(unsigned value, char* buf, int base) {
+  if (base == 16) sprintf(buf, "%x", value);
+  else sprintf(buf, "%u", value);
+  return buf;
+}
+
+char* ultoa(unsigned long value, char* buf, int base) {
+  if (base == 16) sprintf(buf, "%lx", value);
+  else sprintf(buf, "%lu", value);
+  return buf;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::print(long value, int base) {
+  char buf[24];
+  if (base == 16) snprintf(buf, sizeof(buf), "%lx", value);
+  else snprintf(buf, sizeof(buf), "%ld", value);
+  return write(buf);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char buf[24];
+  if (base == 16) snprintf(buf, sizeof(buf), "%lx", value);
+  else snprintf(buf, sizeof(buf), "%lu", value);
+  return write(buf);
+}
+
+size_t Print::print(double value, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, value);
+  return write(buf);
+}
+
+int HardwareSerial::available() { return (int)host::serialInput.size(); }
+int HardwareSerial::peek() { return host::serialInput.empty() ? -1 : (uint8_t)host::serialInput[0]; }
+int HardwareSerial::read() {
+  if (host::serialInput.empty()) return -1;
+  int c = (uint8_t)host::serialInput[0];
+  host::serialInput.erase(0, 1);
+  return c;
+}
+size_t HardwareSerial::write(uint8_t c) {
+  if (host::serialEcho) fputc(c, stdout);
+  return 1;
+}
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (host::serialEcho) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+uint32_t EspClass::getCycleCount() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
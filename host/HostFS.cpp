@@ -0,0 +1,78 @@
+/**
+ * Host shim implementation for LittleFS
+ */
+
+#include "LittleFS.h"
+
+HostFS LittleFS;
+
+bool File::seek(uint32_t offset, SeekMode mode) {
+  if (!data) return false;
+  size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : data->size();
+  if (base + offset > data->size()) return false;
+  pos = base + offset;
+  return true;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!data) return 0;
+  size_t n = std::min(size, data->size() - pos);
+  memcpy(buf, data->data() + pos, n);
+  pos += n;
+  return n;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!data || !writable) return 0;
+  
+  // Growth beyond the filesystem's capacity is cut short
+  size_t grow = pos + size > data->size() ? pos + size - data->size() : 0;
+  size_t free = LittleFS.capacity - std::min(LittleFS.capacity, LittleFS.used());
+  if (grow > free) size -= grow - free;
+  
+  if (pos + size > data->size()) data->resize(pos + size);
+  memcpy(data->data() + pos, buf, size);
+  pos += size;
+  return size;
+}
+
+bool File::truncate(uint32_t size) {
+  if (!data || !writable) return false;
+  data->resize(size);
+  if (pos > size) pos = size;
+  return true;
+}
+
+size_t HostFS::used() const {
+  size_t total = 0;
+  for (const auto& file : files) total += file.second->size();
+  return total;
+}
+
+File HostFS::open(const char* path, const char* mode) {
+  auto it = files.find(path);
+  if (mode[0] == 'r') {
+    if (it == files.end()) return File();
+    return File(it->second, mode[1] == '+');
+  }
+  
+  if (it == files.end() || mode[0] == 'w') {
+    files[path] = std::make_shared<std::vector<uint8_t>>();
+  }
+  File f(files[path], true);
+  if (mode[0] == 'a') f.seek(0, SeekEnd);
+  return f;
+}
+
+bool HostFS::rename(const char* from, const char* to) {
+  auto it = files.find(from);
+  if (it == files.end()) return false;
+  files[to] = it->second;
+  files.erase(it);
+  return true;
+}
@@ -0,0 +1,129 @@
+/**
+ * Host shim implementation for GFX and SSD1306
+ */
+
+#include "Adafruit_SSD1306.h"
+
+TwoWire Wire;
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w <= 0 || h <= 0) return;
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t j = y; j < y + h; j++) {
+    for (int16_t i = x; i < x + w; i++) drawPixel(i, j, color);
+  }
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t x = r, y = 0;
+  int err = 1 - r;
+  while (x >= y) {
+    drawPixel(x0 + x, y0 + y, color); drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color); drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color); drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color); drawPixel(x0 - y, y0 - x, color);
+    y++;
+    if (err < 0) err += 2 * y + 1;
+    else { x--; err += 2 * (y - x) + 1; }
+  }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  for (int16_t dy = -r; dy <= r; dy++) {
+    for (int16_t dx = -r; dx <= r; dx++) {
+      if (dx * dx + dy * dy <= r * r + r) drawPixel(x0 + dx, y0 + dy, color);
+    }
+  }
+}
+
+void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+  drawLine(x0, y0, x1, y1, color);
+  drawLine(x1, y1, x2, y2, color);
+  drawLine(x2, y2, x0, y0, color);
+}
+
+void Adafruit_GFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color) {
+  int16_t minX = std::min(x0, std::min(x1, x2)), maxX = std::max(x0, std::max(x1, x2));
+  int16_t minY = std::min(y0, std::min(y1, y2)), maxY = std::max(y0, std::max(y1, y2));
+  long area = (long)(x1 - x0) * (y2 - y0) - (long)(x2 - x0) * (y1 - y0);
+  for (int16_t y = minY; y <= maxY; y++) {
+    for (int16_t x = minX; x <= maxX; x++) {
+      long w0 = (long)(x1 - x) * (y2 - y) - (long)(x2 - x) * (y1 - y);
+      long w1 = (long)(x2 - x) * (y0 - y) - (long)(x0 - x) * (y2 - y);
+      long w2 = (long)(x0 - x) * (y1 - y) - (long)(x1 - x) * (y0 - y);
+      bool inside = area >= 0 ? (w0 >= 0 && w1 >= 0 && w2 >= 0) : (w0 <= 0 && w1 <= 0 && w2 <= 0);
+      if (inside) drawPixel(x, y, color);
+    }
+  }
+  drawTriangle(x0, y0, x1, y1, x2, y2, color);
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursorX = 0;
+    cursorY += 8 * textSize;
+  } else if (c != '\r') {
+    cursorX += 6 * textSize;
+  }
+  return 1;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst)
+  : Adafruit_GFX(w, h) {
+  (void)twi; (void)rst;
+  memset(buffer, 0, sizeof(buffer));
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr) {
+  (void)vcs; (void)addr;
+  return true;
+}
+
+void Adafruit_SSD1306::display() {
+  flushCount++;
+  host::advanceMicros(flushMicros);
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  memset(buffer, 0, sizeof(buffer));
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  if (c == SSD1306_DISPLAYOFF) panelOn = false;
+  else if (c == SSD1306_DISPLAYON) panelOn = true;
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  uint8_t* byte = &buffer[x + (y / 8) * _width];
+  uint8_t bit = 1 << (y & 7);
+  switch (color) {
+    case SSD1306_WHITE: *byte |= bit; break;
+    case SSD1306_BLACK: *byte &= ~bit; break;
+    case SSD1306_INVERSE: *byte ^= bit; break;
+  }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return false;
+  return buffer[x + (y / 8) * _width] & (1 << (y & 7));
+}
@@ -0,0 +1,45 @@
+/**
+ * Host Ticker implementation
+ */
+
+#include "Ticker.h"
+
+static Ticker* attached = NULL;
+
+void Ticker::attach_ms(uint32_t milliseconds, callback_t callback) {
+  detach();
+  this->callback = callback;
+  periodMicros = (uint64_t)(milliseconds ? milliseconds : 1) * 1000;
+  dueMicros = host::clockMicros + periodMicros;
+  next = attached;
+  attached = this;
+  host::clockHook = runDue;
+}
+
+void Ticker::detach() {
+  for (Ticker** link = &attached; *link; link = &(*link)->next) {
+    if (*link == this) {
+      *link = next;
+      break;
+    }
+  }
+  callback = NULL;
+  next = NULL;
+}
+
+void Ticker::runDue() {
+  // A callback that delays moves the clock again; it must not recurse
+  static bool running = false;
+  if (running) return;
+  running = true;
+  
+  for (Ticker* t = attached; t; ) {
+    Ticker* following = t->next;
+    while (t->callback && host::clockMicros >= t->dueMicros) {
+      t->dueMicros += t->periodMicros;
+      t->callback();
+    }
+    t = following;
+  }
+  running = false;
+}
@@ -0,0 +1,68 @@
+/**
+ * Host shim for the ESP8266 LittleFS filesystem
+ *
+ * Files live in memory for the life of the process. setCapacity() caps
+ * the total size, so writes past it come up short as on a full flash.
+ */
+
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Print {
+  public:
+    File() {}
+    File(std::shared_ptr<std::vector<uint8_t>> data, bool writable)
+      : data(data), writable(writable) {}
+    
+    operator bool() const { return (bool)data; }
+    size_t size() const { return data ? data->size() : 0; }
+    size_t position() const { return pos; }
+    int available() { return data ? (int)(data->size() - pos) : 0; }
+    bool seek(uint32_t offset, SeekMode mode = SeekSet);
+    size_t read(uint8_t* buf, size_t size);
+    int read();
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    bool truncate(uint32_t size);
+    void flush() {}
+    void close() { data.reset(); }
+    
+  private:
+    std::shared_ptr<std::vector<uint8_t>> data;
+    size_t pos = 0;
+    bool writable = false;
+    
+    friend class HostFS;
+};
+
+class HostFS {
+  public:
+    bool begin() { return true; }
+    void end() {}
+    bool format() { files.clear(); return true; }
+    bool exists(const char* path) { return files.count(path) > 0; }
+    File open(const char* path, const char* mode);
+    bool remove(const char* path) { return files.erase(path) > 0; }
+    bool rename(const char* from, const char* to);
+    
+    void setCapacity(size_t bytes) { capacity = bytes; }
+    size_t used() const;
+    
+  private:
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    size_t capacity = SIZE_MAX;
+    
+    friend class File;
+};
+
+extern HostFS LittleFS;
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * Host shim for the ESP8266 Ticker library
+ *
+ * Callbacks fire from the virtual clock: whenever the host program or a
+ * delay() moves it past a ticker's deadline, the callback runs once per
+ * elapsed period, much as SDK timers run when the sketch yields.
+ */
+
+#ifndef HOST_TICKER_H
+#define HOST_TICKER_H
+
+#include "Arduino.h"
+
+class Ticker {
+  public:
+    typedef void (*callback_t)();
+    
+    Ticker() : callback(NULL), periodMicros(0), dueMicros(0), next(NULL) {}
+    ~Ticker() { detach(); }
+    
+    void attach_ms(uint32_t milliseconds, callback_t callback);
+    void detach();
+    bool active() { return callback != NULL; }
+    
+  private:
+    callback_t callback;
+    uint64_t periodMicros;
+    uint64_t dueMicros;
+    Ticker* next;  // Attached tickers
+    
+    static void runDue();
+};
+
+#endif
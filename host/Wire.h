@@ -0,0 +1,18 @@
+/**
+ * Host shim for the Wire (I2C) library
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire {
+  public:
+    void begin(int sda = -1, int scl = -1) { (void)sda; (void)scl; }
+    void setClock(uint32_t hz) { (void)hz; }
+};
+
+extern TwoWire Wire;
+
+#endif
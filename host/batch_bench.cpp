@@ -0,0 +1,135 @@
+/**
+ * Batch solver validation and throughput
+ *
+ * Draws random launches over the firmware's setting ranges, plus the
+ * edge cases (flat and downward shots from the ground, zero velocity),
+ * and solves them twice: shot by shot with solve() and arcPosition(),
+ * and with PhysicsEngine::solveBatch. Every output is compared bit for
+ * bit. Then both are timed, with and without the position grid.
+ *
+ *   batch_bench [shots] [samples]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Physics.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Outputs {
+  std::vector<float> range, maxHeight, flightTime, x, y;
+  
+  Outputs(int count, int samples)
+    : range(count), maxHeight(count), flightTime(count), x(count * samples), y(count * samples) {}
+  
+  ShotBatchResults view(const std::vector<float>& times) {
+    ShotBatchResults r = {range.data(), maxHeight.data(), flightTime.data(),
+                          times.empty() ? NULL : times.data(), (int)times.size(), x.data(), y.data()};
+    return r;
+  }
+};
+
+static uint32_t rngState = 12345;
+
+static float uniform(float lo, float hi) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return lo + (hi - lo) * (rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+static void solveScalar(const ShotBatch& shots, ShotBatchResults& out) {
+  for (int i = 0; i < shots.count; i++) {
+    float vx, vy;
+    PhysicsEngine::launchVelocity(shots.angle[i], shots.velocity[i], vx, vy);
+    ShotResult r = PhysicsEngine::solve(shots.height[i], shots.gravity[i], shots.angle[i], shots.velocity[i]);
+    out.range[i] = r.range;
+    out.maxHeight[i] = r.maxHeight;
+    out.flightTime[i] = r.flightTime;
+    for (int s = 0; s < out.samples; s++) {
+      Point p = PhysicsEngine::arcPosition(shots.height[i], shots.gravity[i], vx, vy, r.flightTime, out.times[s]);
+      out.x[s * shots.count + i] = p.x;
+      out.y[s * shots.count + i] = p.y;
+    }
+  }
+}
+
+static long differences(const std::vector<float>& a, const std::vector<float>& b) {
+  long n = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (memcmp(&a[i], &b[i], sizeof(float)) != 0) n++;
+  }
+  return n;
+}
+
+static double shotsPerSecond(void (*solver)(const ShotBatch&, ShotBatchResults&),
+                             const ShotBatch& shots, ShotBatchResults& out) {
+  int runs = 0;
+  Clock::time_point start = Clock::now();
+  double seconds;
+  do {
+    solver(shots, out);
+    runs++;
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (seconds < 0.5);
+  return (double)runs * shots.count / seconds;
+}
+
+int main(int argc, char** argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 1 << 20;
+  int samples = argc > 2 ? atoi(argv[2]) : 16;
+  
+  std::vector<float> height(count), gravity(count), angle(count), velocity(count);
+  for (int i = 0; i < count; i++) {
+    height[i] = uniform(MIN_HEIGHT, MAX_HEIGHT);
+    gravity[i] = uniform(MIN_GRAVITY, MAX_GRAVITY);
+    angle[i] = uniform(-MAX_ANGLE, MAX_ANGLE);
+    velocity[i] = uniform(0, MAX_VELOCITY);
+  }
+  // Edge cases at the front: from the ground, flat, downward, at rest
+  const float edges[][4] = {{0, 9.81f, 0, 20}, {0, 9.81f, -30, 20}, {0, 9.81f, 45, 0},
+                            {0, MIN_GRAVITY, 90, MAX_VELOCITY}, {MAX_HEIGHT, MAX_GRAVITY, -90, MAX_VELOCITY}};
+  for (int e = 0; e < 5 && e < count; e++) {
+    height[e] = edges[e][0];
+    gravity[e] = edges[e][1];
+    angle[e] = edges[e][2];
+    velocity[e] = edges[e][3];
+  }
+  ShotBatch shots = {height.data(), gravity.data(), angle.data(), velocity.data(), count};
+  
+  std::vector<float> times(samples);
+  for (int s = 0; s < samples; s++) times[s] = s * 0.5f;
+  std::vector<float> noTimes;
+  
+  Outputs scalar(count, samples), batch(count, samples);
+  ShotBatchResults scalarOut = scalar.view(times);
+  ShotBatchResults batchOut = batch.view(times);
+  solveScalar(shots, scalarOut);
+  PhysicsEngine::solveBatch(shots, batchOut);
+  
+  long mismatches = differences(scalar.range, batch.range) + differences(scalar.maxHeight, batch.maxHeight) +
+                    differences(scalar.flightTime, batch.flightTime) + differences(scalar.x, batch.x) +
+                    differences(scalar.y, batch.y);
+  
+  printf("%d shots, %d samples, kernel %s\n", count, samples, PhysicsEngine::batchKernel());
+  printf("%-10s %14s %14s\n", "", "results/s", "with grid/s");
+  ShotBatchResults scalarBare = scalar.view(noTimes);
+  ShotBatchResults batchBare = batch.view(noTimes);
+  double scalarBareRate = shotsPerSecond(solveScalar, shots, scalarBare);
+  double scalarGridRate = shotsPerSecond(solveScalar, shots, scalarOut);
+  double batchBareRate = shotsPerSecond(PhysicsEngine::solveBatch, shots, batchBare);
+  double batchGridRate = shotsPerSecond(PhysicsEngine::solveBatch, shots, batchOut);
+  printf("%-10s %14.0f %14.0f\n", "scalar", scalarBareRate, scalarGridRate);
+  printf("%-10s %14.0f %14.0f\n", "batch", batchBareRate, batchGridRate);
+  
+  if (mismatches) {
+    printf("%ld outputs differ from the scalar solver\n", mismatches);
+    return 1;
+  }
+  printf("bit-exact with the scalar solver\n");
+  return 0;
+}
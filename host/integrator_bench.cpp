@@ -0,0 +1,183 @@
+/**
+ * Accuracy and cost of the integrators in Integrators.h
+ *
+ * Flies one launch per force model with every integrator at the
+ * firmware's fixed step (SIMULATION_DT) and compares against a
+ * reference: the analytic solution for linear drag, a fine-step
+ * double-precision RK4 for quadratic drag with wind and spin. The range
+ * error includes the linear interpolation of the landing point, which
+ * puts a floor of about a millimetre under it.
+ *
+ *   integrator_bench [steps]
+ *
+ * Host timings only rank the integrators; on the device, select one
+ * with INTEGRATOR in Config.h and read the physics stage from 'perf'.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Integrators.h"
+
+static const float H0 = 2.0f;
+static const float G = 9.81f;
+static const float V0 = 30.0f;
+static const float ANGLE = 45.0f;
+
+struct Reference {
+  double x, y, vx, vy;
+};
+
+// Exact linear-drag trajectory at time t
+static Reference linearDragAt(double k, double t) {
+  double vx0 = V0 * cos(ANGLE * M_PI / 180.0);
+  double vy0 = V0 * sin(ANGLE * M_PI / 180.0);
+  double decay = exp(-k * t);
+  double terminal = G / k;
+  return {vx0 / k * (1 - decay),
+          H0 + (vy0 + terminal) / k * (1 - decay) - terminal * t,
+          vx0 * decay,
+          (vy0 + terminal) * decay - terminal};
+}
+
+// Quadratic drag, wind and Magnus in double precision
+static Reference quadraticDerivative(const Reference& s, double c, double wind, double spin) {
+  double rx = s.vx - wind;
+  double speed = sqrt(rx * rx + s.vy * s.vy);
+  return {s.vx, s.vy, -c * speed * rx - spin * s.vy, -c * speed * s.vy + spin * s.vx - G};
+}
+
+static Reference quadraticStep(Reference s, double h, double c, double wind, double spin) {
+  auto offset = [](const Reference& a, const Reference& d, double f) {
+    return Reference{a.x + d.x * f, a.y + d.y * f, a.vx + d.vx * f, a.vy + d.vy * f};
+  };
+  Reference k1 = quadraticDerivative(s, c, wind, spin);
+  Reference k2 = quadraticDerivative(offset(s, k1, h / 2), c, wind, spin);
+  Reference k3 = quadraticDerivative(offset(s, k2, h / 2), c, wind, spin);
+  Reference k4 = quadraticDerivative(offset(s, k3, h), c, wind, spin);
+  return {s.x + h / 6 * (k1.x + 2 * k2.x + 2 * k3.x + k4.x),
+          s.y + h / 6 * (k1.y + 2 * k2.y + 2 * k3.y + k4.y),
+          s.vx + h / 6 * (k1.vx + 2 * k2.vx + 2 * k3.vx + k4.vx),
+          s.vy + h / 6 * (k1.vy + 2 * k2.vy + 2 * k3.vy + k4.vy)};
+}
+
+struct Accuracy {
+  double rangeError;
+  double maxPositionError;
+};
+
+// Flies to the ground at SIMULATION_DT, comparing each step with the reference
+template <class Integrator, class Model, class RefFn>
+static Accuracy measure(const Model& model, RefFn reference) {
+  float angle = ANGLE * M_PI / 180.0f;
+  BodyState s = {0, H0, V0 * cosf(angle), V0 * sinf(angle)};
+  Accuracy result = {0, 0};
+  
+  for (int n = 1; n < 100000; n++) {
+    BodyState prev = s;
+    advance<Integrator>(s, SIMULATION_DT, G, model);
+    Reference ref = reference(n * (double)SIMULATION_DT);
+    
+    if (s.y <= 0 || ref.y <= 0) {
+      // Range from both trajectories' interpolated ground crossings
+      float f = prev.y / (prev.y - s.y);
+      double x = prev.x + (s.x - prev.x) * f;
+      double refRange = 0;
+      Reference a = reference((n - 1) * (double)SIMULATION_DT);
+      for (int i = 1; i < 4096; i++) {
+        Reference b = reference((n - 1 + i / 64.0) * SIMULATION_DT);
+        if (b.y <= 0) {
+          refRange = a.x + (b.x - a.x) * a.y / (a.y - b.y);
+          break;
+        }
+        a = b;
+      }
+      result.rangeError = fabs(x - refRange);
+      return result;
+    }
+    
+    double error = hypot(s.x - ref.x, s.y - ref.y);
+    if (error > result.maxPositionError) result.maxPositionError = error;
+  }
+  return result;
+}
+
+// Average wall time per step, restarting the flight whenever it lands
+template <class Integrator, class Model>
+static double nanosPerStep(const Model& model, long steps) {
+  float angle = ANGLE * M_PI / 180.0f;
+  BodyState start = {0, H0, V0 * cosf(angle), V0 * sinf(angle)};
+  BodyState s = start;
+  volatile float sink = 0;
+  
+  auto begin = std::chrono::steady_clock::now();
+  for (long i = 0; i < steps; i++) {
+    advance<Integrator>(s, SIMULATION_DT, G, model);
+    if (s.y <= 0) {
+      sink = sink + s.x;
+      s = start;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(end - begin).count() / steps;
+}
+
+template <class Integrator, class Model, class RefFn>
+static void row(const char* modelName, const char* name, const Model& model, RefFn reference, long steps) {
+  Accuracy accuracy = measure<Integrator>(model, reference);
+  int evaluations = Model::closedForm ? 0 : Integrator::evaluations;
+  printf("%-14s %-20s %5d %9.1f %12.5f %12.5f\n", modelName, name, evaluations,
+         nanosPerStep<Integrator>(model, steps), accuracy.rangeError, accuracy.maxPositionError);
+}
+
+template <class Model, class RefFn>
+static void rows(const char* modelName, const Model& model, RefFn reference, long steps) {
+  row<SemiImplicitEuler>(modelName, "semi-implicit-euler", model, reference, steps);
+  row<Verlet>(modelName, "verlet", model, reference, steps);
+  row<RK4>(modelName, "rk4", model, reference, steps);
+  row<RK45>(modelName, "rk45", model, reference, steps);
+}
+
+int main(int argc, char** argv) {
+  long steps = argc > 1 ? atol(argv[1]) : 2000000;
+  
+  printf("dt %.3f s, h0 %.1f m, v0 %.1f m/s, angle %.0f deg\n", SIMULATION_DT, H0, V0, ANGLE);
+  printf("%-14s %-20s %5s %9s %12s %12s\n", "model", "integrator", "evals", "ns/step",
+         "range_err_m", "max_pos_err_m");
+  
+  // Vacuum takes the closed-form step whatever the integrator
+  rows("vacuum", Vacuum(), [](double t) {
+    double vx0 = V0 * cos(ANGLE * M_PI / 180.0);
+    double vy0 = V0 * sin(ANGLE * M_PI / 180.0);
+    return Reference{vx0 * t, H0 + vy0 * t - 0.5 * G * t * t, vx0, vy0 - G * t};
+  }, steps);
+  
+  LinearDrag linear = {LINEAR_DRAG_K};
+  rows("linear", linear, [](double t) { return linearDragAt(LINEAR_DRAG_K, t); }, steps);
+  
+  // Reference advanced lazily; queries only move forward except for
+  // the final landing search, which restarts from the beginning
+  const double c = QUADRATIC_DRAG_C, wind = -3.0, spin = 0.02;
+  Combined<Wind<QuadraticDrag>, Magnus> full = {{{QUADRATIC_DRAG_C}, (float)wind}, {(float)spin}};
+  auto quadratic = [&](double t) {
+    static Reference state;
+    static double time = -1;
+    const double h = 1e-4;
+    if (time < 0 || t < time) {
+      double angle = ANGLE * M_PI / 180.0;
+      state = {0, H0, V0 * cos(angle), V0 * sin(angle)};
+      time = 0;
+    }
+    while (time + h <= t) {
+      state = quadraticStep(state, h, c, wind, spin);
+      time += h;
+    }
+    return quadraticStep(state, t - time, c, wind, spin);
+  };
+  rows("quad+wind+spin", full, quadratic, steps);
+  
+  return 0;
+}
@@ -0,0 +1,320 @@
+/**
+ * Parallel Monte Carlo launch dispersion
+ *
+ * Flies millions of perturbed launches through PhysicsEngine (terrain,
+ * obstacles, bounces and the compiled force model included) on every
+ * core and reports the distribution of where they come to rest.
+ *
+ * The shots are cut into fixed chunks. Each worker starts with a
+ * contiguous run of chunks in its own queue, pops from the front, and
+ * steals from the back of another queue once its own is empty. A chunk
+ * seeds its own PCG32 stream (seed, chunk index) and writes its impacts
+ * to a fixed slot, so the result depends only on the seed and the
+ * chunk size, never on the thread count or on who stole what.
+ *
+ *   montecarlo [-n shots] [--seed s] [--threads t] [--chunk c]
+ *              [--height h] [--gravity g] [--angle deg] [--velocity v]
+ *              [--<param>-dist none|normal|uniform] [--<param>-spread x]
+ *   montecarlo --scaling [-n shots] [--threads max]
+ *
+ * Spreads default to the DISPERSION_* settings in Config.h. --scaling
+ * reruns the same seed at 1, 2, 4 ... threads, prints throughput and
+ * efficiency, and fails if any run's statistics differ from the first.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Dispersion.h"
+#include "Obstacles.h"
+#include "Terrain.h"
+
+// Longest flight followed, in fixed steps
+static const int MAX_STEPS = 100000;
+
+struct Options {
+  long shots = 1000000;
+  uint64_t seed = DISPERSION_SEED;
+  int threads = 0;  // 0: all cores
+  int chunk = 4096;
+  bool scaling = false;
+  LaunchSettings nominal = {0.0f, 9.81f, 45.0f, 20.0f};
+  LaunchSpread spread = defaultLaunchSpread();
+};
+
+struct Impacts {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> time;
+};
+
+struct WorkQueue {
+  std::mutex lock;
+  std::deque<long> chunks;
+};
+
+struct Stats {
+  double meanX, meanY, sigmaX, sigmaY, meanTime;
+  float minX, maxX;
+  float cep50, cep90;
+  float percentiles[7];
+};
+
+static const float PERCENTILES[] = {1, 5, 25, 50, 75, 95, 99};
+
+static bool takeChunk(std::vector<WorkQueue>& queues, int self, long& chunk) {
+  {
+    std::lock_guard<std::mutex> guard(queues[self].lock);
+    if (!queues[self].chunks.empty()) {
+      chunk = queues[self].chunks.front();
+      queues[self].chunks.pop_front();
+      return true;
+    }
+  }
+  // Nothing new is ever queued, so one empty pass means all work is taken
+  for (size_t i = 1; i < queues.size(); i++) {
+    WorkQueue& victim = queues[(self + i) % queues.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.chunks.empty()) {
+      chunk = victim.chunks.back();
+      victim.chunks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+static void flyChunk(const Options& options, long chunk, PhysicsEngine& engine, Impacts& out) {
+  Pcg32 rng;
+  rng.seed(options.seed, chunk);
+  long first = chunk * options.chunk;
+  long last = min(first + options.chunk, options.shots);
+  for (long i = first; i < last; i++) {
+    LaunchSettings launch = perturbLaunch(rng, options.spread, options.nominal);
+    engine.startSimulation(launch.height, launch.gravity, launch.angle, launch.velocity);
+    engine.run(MAX_STEPS);
+    Point rest = engine.getCurrentPosition();
+    out.x[i] = engine.getTotalRange();
+    out.y[i] = rest.y;
+    out.time[i] = engine.getFlightTime();
+  }
+}
+
+// Returns wall seconds; stolen counts chunks flown away from their home queue
+static double run(const Options& options, int threads, Impacts& out, long& stolen) {
+  long chunks = (options.shots + options.chunk - 1) / options.chunk;
+  out.x.assign(options.shots, 0);
+  out.y.assign(options.shots, 0);
+  out.time.assign(options.shots, 0);
+  
+  std::vector<WorkQueue> queues(threads);
+  for (long c = 0; c < chunks; c++) {
+    queues[c * threads / chunks].chunks.push_back(c);
+  }
+  
+  std::atomic<long> steals(0);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      PhysicsEngine engine;
+      engine.begin();
+      long chunk;
+      while (takeChunk(queues, t, chunk)) {
+        if (chunk * threads / chunks != t) steals++;
+        flyChunk(options, chunk, engine, out);
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  stolen = steals;
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool sameStats(const Stats& a, const Stats& b) {
+  if (a.meanX != b.meanX || a.meanY != b.meanY || a.sigmaX != b.sigmaX || a.sigmaY != b.sigmaY ||
+      a.meanTime != b.meanTime || a.minX != b.minX || a.maxX != b.maxX ||
+      a.cep50 != b.cep50 || a.cep90 != b.cep90) {
+    return false;
+  }
+  for (int i = 0; i < 7; i++) {
+    if (a.percentiles[i] != b.percentiles[i]) return false;
+  }
+  return true;
+}
+
+static float percentileOf(std::vector<float>& values, float p) {
+  size_t k = min(values.size() - 1, (size_t)(p / 100.0f * values.size()));
+  std::nth_element(values.begin(), values.begin() + k, values.end());
+  return values[k];
+}
+
+static Stats summarize(const Impacts& impacts) {
+  // Sums in shot order keep the numbers independent of scheduling
+  Stats s = {};
+  size_t n = impacts.x.size();
+  double sumX = 0, sumY = 0, sumTime = 0;
+  s.minX = impacts.x[0];
+  s.maxX = impacts.x[0];
+  for (size_t i = 0; i < n; i++) {
+    sumX += impacts.x[i];
+    sumY += impacts.y[i];
+    sumTime += impacts.time[i];
+    s.minX = min(s.minX, impacts.x[i]);
+    s.maxX = max(s.maxX, impacts.x[i]);
+  }
+  s.meanX = sumX / n;
+  s.meanY = sumY / n;
+  s.meanTime = sumTime / n;
+  
+  double squaresX = 0, squaresY = 0;
+  std::vector<float> miss(n);
+  for (size_t i = 0; i < n; i++) {
+    double dx = impacts.x[i] - s.meanX;
+    double dy = impacts.y[i] - s.meanY;
+    squaresX += dx * dx;
+    squaresY += dy * dy;
+    miss[i] = sqrt(dx * dx + dy * dy);
+  }
+  s.sigmaX = n > 1 ? sqrt(squaresX / (n - 1)) : 0;
+  s.sigmaY = n > 1 ? sqrt(squaresY / (n - 1)) : 0;
+  s.cep50 = percentileOf(miss, 50);
+  s.cep90 = percentileOf(miss, 90);
+  
+  std::vector<float> ranges = impacts.x;
+  for (int i = 0; i < 7; i++) {
+    s.percentiles[i] = percentileOf(ranges, PERCENTILES[i]);
+  }
+  return s;
+}
+
+static void printStats(const Stats& s) {
+  printf("range   mean %.3f  sigma %.3f  min %.3f  max %.3f m\n", s.meanX, s.sigmaX, s.minX, s.maxX);
+  printf("height  mean %.3f  sigma %.3f m\n", s.meanY, s.sigmaY);
+  printf("time    mean %.3f s\n", s.meanTime);
+  printf("CEP50   %.3f m  CEP90 %.3f m\n", s.cep50, s.cep90);
+  printf("range percentiles");
+  for (int i = 0; i < 7; i++) {
+    printf("  p%g %.3f", PERCENTILES[i], s.percentiles[i]);
+  }
+  printf("\n");
+}
+
+static bool parseDistribution(const char* name, uint8_t& kind) {
+  if (!strcmp(name, "none")) kind = DIST_NONE;
+  else if (!strcmp(name, "normal")) kind = DIST_NORMAL;
+  else if (!strcmp(name, "uniform")) kind = DIST_UNIFORM;
+  else return false;
+  return true;
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+  struct Param {
+    const char* name;
+    float* nominal;
+    Distribution* spread;
+  } params[] = {
+    {"height", &options.nominal.height, &options.spread.height},
+    {"gravity", &options.nominal.gravity, &options.spread.gravity},
+    {"angle", &options.nominal.angle, &options.spread.angle},
+    {"velocity", &options.nominal.velocity, &options.spread.velocity}
+  };
+  
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!strcmp(arg, "--scaling")) {
+      options.scaling = true;
+      continue;
+    }
+    if (!value || strncmp(arg, "-", 1)) return false;
+    i++;
+    
+    if (!strcmp(arg, "-n")) options.shots = atol(value);
+    else if (!strcmp(arg, "--seed")) options.seed = strtoull(value, NULL, 0);
+    else if (!strcmp(arg, "--threads")) options.threads = atoi(value);
+    else if (!strcmp(arg, "--chunk")) options.chunk = max(1, atoi(value));
+    else {
+      bool known = false;
+      for (Param& p : params) {
+        size_t len = strlen(p.name);
+        if (strncmp(arg, "--", 2) || strncmp(arg + 2, p.name, len)) continue;
+        const char* suffix = arg + 2 + len;
+        if (!*suffix) {
+          *p.nominal = atof(value);
+          known = true;
+        } else if (!strcmp(suffix, "-spread")) {
+          p.spread->spread = atof(value);
+          known = true;
+        } else if (!strcmp(suffix, "-dist")) {
+          known = parseDistribution(value, p.spread->kind);
+        }
+      }
+      if (!known) return false;
+    }
+  }
+  return options.shots > 0;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s [-n shots] [--seed s] [--threads t] [--chunk c] [--scaling]\n"
+                    "       [--height|--gravity|--angle|--velocity x] [--<param>-dist none|normal|uniform]\n"
+                    "       [--<param>-spread x]\n", argv[0]);
+    return 2;
+  }
+  terrain.begin();
+  obstacles.begin();
+  
+  int cores = max(1u, std::thread::hardware_concurrency());
+  int maxThreads = options.threads > 0 ? options.threads : cores;
+  printf("launch h0 %.2f m, g %.2f m/s^2, %.2f deg, %.2f m/s; %ld shots, seed %llu, chunk %d\n",
+         options.nominal.height, options.nominal.gravity, options.nominal.angle, options.nominal.velocity,
+         options.shots, (unsigned long long)options.seed, options.chunk);
+         
+  Impacts impacts;
+  long stolen = 0;
+  if (!options.scaling) {
+    double seconds = run(options, maxThreads, impacts, stolen);
+    printf("%d threads, %.3f s, %.2f M shots/s, %ld chunks stolen\n", maxThreads, seconds,
+           options.shots / seconds / 1e6, stolen);
+    printStats(summarize(impacts));
+    return 0;
+  }
+  
+  // Thread counts 1, 2, 4 ... up to the limit, plus the limit itself
+  std::vector<int> counts;
+  for (int t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+  counts.push_back(maxThreads);
+  
+  printf("%8s %10s %12s %8s %10s %8s\n", "threads", "seconds", "Mshots/s", "speedup", "efficiency", "stolen");
+  Stats first = {};
+  double baseSeconds = 0;
+  bool identical = true;
+  for (size_t i = 0; i < counts.size(); i++) {
+    double seconds = run(options, counts[i], impacts, stolen);
+    Stats s = summarize(impacts);
+    if (i == 0) {
+      first = s;
+      baseSeconds = seconds;
+    } else if (!sameStats(s, first)) {
+      identical = false;
+    }
+    double speedup = baseSeconds / seconds;
+    printf("%8d %10.3f %12.2f %8.2f %9.0f%% %8ld\n", counts[i], seconds, options.shots / seconds / 1e6,
+           speedup, 100.0 * speedup / counts[i], stolen);
+  }
+  printStats(first);
+  printf("results %s across thread counts\n", identical ? "identical" : "DIFFER");
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/**
+ * Cost of a build profile
+ *
+ * Built once per profile (-DBUILD_PROFILE=0..3). Prints the profile's
+ * path sizes, its modelled RAM and frame cost against the budgets that
+ * Profile.h checks at compile time, the real sizes of the objects it
+ * shapes, and host time for the work it scales: recomputing the
+ * prediction, and drawing the angle and simulation screens with every
+ * buffer full and every ghost arc recorded.
+ *
+ *   profile_bench [frames]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <Adafruit_SSD1306.h>
+#include "Obstacles.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include "Terrain.h"
+#include "UI.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double microsSince(Clock::time_point start, int count) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+}
+
+int main(int argc, char** argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 2000;
+  
+  terrain.begin();
+  obstacles.begin();
+  profiler.begin();  // render() times itself
+  Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT);
+  display.begin();
+  PhysicsEngine engine;
+  engine.begin();
+  flightSnapshots.begin();
+  UIRenderer ui(&display, &engine);
+  ui.begin();
+  ghosts.begin();
+  for (int i = 0; i < BUILD.ghostShots; i++) {
+    float angle = 30 + i * 5, velocity = 25 + i;
+    ghosts.record(5, 9.81f, angle, velocity, PhysicsEngine::solve(5.0f, 9.81f, angle, velocity).flightTime);
+  }
+  
+  printf("profile %s: %d prediction, %d trail, %d dotted points, %d ghosts, %d ms frames\n", BUILD.name,
+         BUILD.predictionPoints, BUILD.trailPoints, BUILD.dottedPoints, BUILD.ghostShots, BUILD.frameTimeMs);
+  printf("  path RAM    %6u / %6u bytes (model)\n", (unsigned)profileRamBytes(BUILD),
+         (unsigned)BUILD.ramBudget);
+  printf("  frame cost  %6u / %6u us (model, ESP8266)\n", (unsigned)profileFrameCostUs(BUILD),
+         (unsigned)(BUILD.frameTimeMs * 1000));
+  printf("  objects     engine %u, renderer %u, snapshots %u bytes\n", (unsigned)sizeof(PhysicsEngine),
+         (unsigned)sizeof(UIRenderer), (unsigned)sizeof(flightSnapshots));
+  
+  // Prediction, swept over the angle range
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < frames; i++) {
+    engine.setParameters(5, 9.81f, 10 + i % 70, 30);
+  }
+  double predictionUs = microsSince(start, frames);
+  
+  ui.setAngle(45);
+  ui.setCannonMouthPosition(45, 5);
+  engine.setParameters(5, 9.81f, 45, 30);
+  start = Clock::now();
+  for (int i = 0; i < frames; i++) {
+    ui.render(4);  // ANGLE_ADJUST
+  }
+  double angleUs = microsSince(start, frames);
+  
+  // A flight far enough along that the trail and dotted path are full
+  engine.startSimulation(5, 9.81f, 45, 30);
+  for (int i = 0; i < BUILD.dottedPoints && !engine.isSimulationComplete(); i++) {
+    engine.run(1);
+    ui.addDottedPathPoint(engine.getCurrentPosition().x, engine.getCurrentPosition().y);
+  }
+  publishFlight(engine);
+  ui.setSimulationData(&flightSnapshots.acquire());
+  start = Clock::now();
+  for (int i = 0; i < frames; i++) {
+    ui.render(6);  // SIMULATION_RUN
+  }
+  double simulationUs = microsSince(start, frames);
+  
+  printf("  host time   prediction %.2f us, angle frame %.2f us, flight frame %.2f us\n",
+         predictionUs, angleUs, simulationUs);
+  return 0;
+}
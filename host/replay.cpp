@@ -0,0 +1,303 @@
+/**
+ * Headless replay of scripted user sessions
+ *
+ * Runs the sketch's setup() and loop() against the host shim with a
+ * virtual millis() clock, feeding button edges from input scripts as
+ * fast as the CPU allows. Each script runs in its own forked process
+ * so every run starts from freshly initialized globals.
+ *
+ *   replay [--step-us N] [--flush-us N] [--latency] [--echo] script.txt...
+ *   replay --serial
+ *
+ * --flush-us charges each display() that much virtual time, as the I2C
+ * transfer would. --latency prints the input-to-photon latency of each
+ * state after a script, and charges COST_FLUSH_US per flush unless
+ * --flush-us says otherwise.
+ *
+ * --serial bridges the sketch's Serial to stdin/stdout instead, so
+ * tools such as batch_check.py can drive a host build.
+ *
+ * Script lines (times in virtual ms since power-on, # starts a comment):
+ *   <ms> press <UP|DOWN|ENTER>
+ *   <ms> release <UP|DOWN|ENTER>
+ *   <ms> tap <UP|DOWN|ENTER> [hold_ms]   press, release after hold_ms (100)
+ *   <ms> serial <text>                   console line
+ *   <ms> expect <STATE>                  fail unless in STATE at that time
+ *   <ms> reboot                          run setup() again (flash survives)
+ *   <ms> end                             stop (default: last event + 500)
+ */
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/ProjectileMachine_OLED/ProjectileMachine_OLED.ino"
+
+static const char* STATE_NAMES[] = {
+  "BOOT_ANIM", "HEIGHT_SELECT", "GRAVITY_MENU", "MORSE_INPUT",
+  "ANGLE_ADJUST", "VELOCITY_ADJUST", "SIMULATION_RUN", "RESULTS",
+  "LOG_SUMMARY", "SALVO_RUN", "SALVO_RESULTS",
+  "TARGETING", "SWEEP"
+};
+static const int STATE_NAME_COUNT = sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]);
+static const int MAX_TRACKED_STATES = 32;
+
+struct ScriptEvent {
+  enum Kind { PRESS, RELEASE, SERIAL_LINE, EXPECT, REBOOT, END };
+  unsigned long atMs;
+  Kind kind;
+  uint8_t pin;
+  int state;
+  std::string text;
+  int line;
+};
+
+static const char* stateName(int state) {
+  static char buf[8];
+  if (state >= 0 && state < STATE_NAME_COUNT) return STATE_NAMES[state];
+  snprintf(buf, sizeof(buf), "%d", state);
+  return buf;
+}
+
+static int parseState(const std::string& name) {
+  for (int i = 0; i < STATE_NAME_COUNT; i++) {
+    if (name == STATE_NAMES[i]) return i;
+  }
+  return isdigit((unsigned char)name[0]) ? atoi(name.c_str()) : -1;
+}
+
+static int parseButton(const std::string& name) {
+  if (name == "UP") return BUTTON_UP;
+  if (name == "DOWN") return BUTTON_DOWN;
+  if (name == "ENTER") return BUTTON_ENTER;
+  return -1;
+}
+
+static bool loadScript(const char* path, std::vector<ScriptEvent>& events) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+  
+  std::string text;
+  int lineNo = 0;
+  while (std::getline(in, text)) {
+    lineNo++;
+    size_t hash = text.find('#');
+    if (hash != std::string::npos) text.erase(hash);
+    
+    std::istringstream line(text);
+    unsigned long at;
+    std::string verb;
+    if (!(line >> at >> verb)) continue;
+    
+    ScriptEvent ev = {at, ScriptEvent::END, 0, -1, "", lineNo};
+    std::string arg;
+    if (verb == "press" || verb == "release" || verb == "tap") {
+      line >> arg;
+      int pin = parseButton(arg);
+      if (pin < 0) {
+        fprintf(stderr, "%s:%d: unknown button '%s'\n", path, lineNo, arg.c_str());
+        return false;
+      }
+      ev.pin = pin;
+      ev.kind = verb == "release" ? ScriptEvent::RELEASE : ScriptEvent::PRESS;
+      events.push_back(ev);
+      if (verb == "tap") {
+        unsigned long hold = 100;
+        line >> hold;
+        ev.kind = ScriptEvent::RELEASE;
+        ev.atMs = at + hold;
+        events.push_back(ev);
+      }
+    } else if (verb == "serial") {
+      std::getline(line >> std::ws, ev.text);
+      ev.kind = ScriptEvent::SERIAL_LINE;
+      events.push_back(ev);
+    } else if (verb == "expect") {
+      line >> arg;
+      ev.kind = ScriptEvent::EXPECT;
+      ev.state = parseState(arg);
+      if (ev.state < 0) {
+        fprintf(stderr, "%s:%d: unknown state '%s'\n", path, lineNo, arg.c_str());
+        return false;
+      }
+      ev.text = arg;
+      events.push_back(ev);
+    } else if (verb == "reboot") {
+      ev.kind = ScriptEvent::REBOOT;
+      events.push_back(ev);
+    } else if (verb == "end") {
+      events.push_back(ev);
+    } else {
+      fprintf(stderr, "%s:%d: unknown verb '%s'\n", path, lineNo, verb.c_str());
+      return false;
+    }
+  }
+  
+  std::stable_sort(events.begin(), events.end(),
+    [](const ScriptEvent& a, const ScriptEvent& b) { return a.atMs < b.atMs; });
+  return true;
+}
+
+static void printLatency() {
+  printf("  %-16s %8s %8s %8s %8s\n", "latency", "inputs", "avg_ms", "p95_ms", "max_ms");
+  for (int i = 0; i < LATENCY_MAX_STATES; i++) {
+    if (latency.getCount(i) == 0) continue;
+    printf("  %-16s %8u %8.1f %8.1f %8.1f\n", stateName(i), latency.getCount(i),
+           latency.getAverageMs(i), latency.getPercentileMs(i, 95), latency.getPercentileMs(i, 100));
+  }
+}
+
+static int runScript(const char* path, unsigned long stepMicros, bool reportLatency) {
+  std::vector<ScriptEvent> events;
+  if (!loadScript(path, events)) return 2;
+  
+  unsigned long endMs = events.empty() ? 0 : events.back().atMs + 500;
+  for (const ScriptEvent& ev : events) {
+    if (ev.kind == ScriptEvent::END) {
+      endMs = ev.atMs;
+      break;
+    }
+  }
+  
+  uint64_t dwellMicros[MAX_TRACKED_STATES] = {0};
+  uint64_t wallNanos[MAX_TRACKED_STATES] = {0};
+  unsigned long entries[MAX_TRACKED_STATES] = {0};
+  unsigned long loops = 0;
+  int failures = 0;
+  size_t next = 0;
+  
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  
+  host::clockMicros = 0;
+  setup();
+  int lastState = -1;
+  
+  while (millis() < endMs) {
+    while (next < events.size() && events[next].atMs <= millis()) {
+      const ScriptEvent& ev = events[next++];
+      switch (ev.kind) {
+        case ScriptEvent::PRESS: host::pinLevels[ev.pin] = LOW; break;
+        case ScriptEvent::RELEASE: host::pinLevels[ev.pin] = HIGH; break;
+        case ScriptEvent::SERIAL_LINE: host::serialFeed((ev.text + "\n").c_str()); break;
+        case ScriptEvent::EXPECT:
+          if ((int)currentState != ev.state) {
+            printf("%s:%d: at %lu ms expected %s, in %s\n", path, ev.line, ev.atMs,
+                   ev.text.c_str(), stateName(currentState));
+            failures++;
+          }
+          break;
+        case ScriptEvent::REBOOT: setup(); break;
+        case ScriptEvent::END: break;
+      }
+    }
+    
+    int state = currentState;
+    if (state != lastState && state < MAX_TRACKED_STATES) entries[state]++;
+    lastState = state;
+    
+    // Virtual time also moves inside loop() when the sketch idles
+    uint64_t virtualStart = host::clockMicros;
+    Clock::time_point loopStart = Clock::now();
+    loop();
+    host::advanceMicros(stepMicros);
+    if (state < MAX_TRACKED_STATES) {
+      wallNanos[state] += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - loopStart).count();
+      dwellMicros[state] += host::clockMicros - virtualStart;
+    }
+    loops++;
+  }
+  
+  double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  printf("%s: %.2f s virtual in %.2f ms wall (%.0fx), %lu loops, %lu frames, %d failed\n",
+         path, endMs / 1000.0, wallMs, endMs / max(wallMs, 1e-3), loops,
+         display.flushCount, failures);
+  printf("  %-16s %8s %6s %10s %8s\n", "state", "dwell_ms", "share", "wall_us", "entries");
+  for (int i = 0; i < MAX_TRACKED_STATES; i++) {
+    if (dwellMicros[i] == 0) continue;
+    printf("  %-16s %8llu %5.1f%% %10.1f %8lu\n", stateName(i),
+           (unsigned long long)(dwellMicros[i] / 1000), 100.0 * dwellMicros[i] / 1000.0 / max(endMs, 1UL),
+           wallNanos[i] / 1000.0, entries[i]);
+  }
+  if (reportLatency) printLatency();
+  fflush(stdout);
+  return failures ? 1 : 0;
+}
+
+static int runSerialBridge(unsigned long stepMicros) {
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  host::serialEcho = true;
+  setup();
+  
+  bool inputOpen = true;
+  unsigned long idleLoops = 0;
+  while (inputOpen || idleLoops < 1000) {
+    struct pollfd pfd = {0, POLLIN, 0};
+    if (inputOpen && poll(&pfd, 1, 0) > 0) {
+      char buf[4096];
+      ssize_t n = read(0, buf, sizeof(buf) - 1);
+      if (n <= 0) {
+        inputOpen = false;
+      } else {
+        buf[n] = '\0';
+        host::serialFeed(buf);
+      }
+    }
+    if (!inputOpen) idleLoops++;
+    
+    loop();
+    host::advanceMicros(stepMicros);
+  }
+  fflush(stdout);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  unsigned long stepMicros = 1000;
+  long flushMicros = -1;
+  bool reportLatency = false;
+  bool serialBridge = false;
+  std::vector<const char*> scripts;
+  
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--step-us") && i + 1 < argc) stepMicros = atol(argv[++i]);
+    else if (!strcmp(argv[i], "--flush-us") && i + 1 < argc) flushMicros = atol(argv[++i]);
+    else if (!strcmp(argv[i], "--latency")) reportLatency = true;
+    else if (!strcmp(argv[i], "--echo")) host::serialEcho = true;
+    else if (!strcmp(argv[i], "--serial")) serialBridge = true;
+    else scripts.push_back(argv[i]);
+  }
+  
+  if (flushMicros < 0) flushMicros = reportLatency ? COST_FLUSH_US : 0;
+  display.flushMicros = flushMicros;
+  
+  if (serialBridge) return runSerialBridge(stepMicros);
+  if (scripts.empty()) {
+    fprintf(stderr, "usage: %s [--step-us N] [--flush-us N] [--latency] [--echo] script...\n       %s --serial\n",
+            argv[0], argv[0]);
+    return 2;
+  }
+  
+  int failed = 0;
+  for (const char* path : scripts) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+      _exit(runScript(path, stepMicros, reportLatency));
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+  }
+  
+  printf("%zu scripts, %d failed\n", scripts.size(), failed);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * Simulation and rendering split over the flight snapshot buffer
+ *
+ * A producer thread flies launch after launch through PhysicsEngine and
+ * publishes a FlightSnapshot after every step. A consumer thread
+ * acquires the newest one and draws the simulation screen with the
+ * firmware's UIRenderer into the host frame buffer. Neither side ever
+ * waits for the other. For comparison, the same work first runs on one
+ * thread, alternating a step and a frame.
+ *
+ * Every acquired snapshot is checked: its newest trail point must be its
+ * position, and its trail length must match its step count. A torn
+ * handoff breaks one of these. Build with -fsanitize=thread to have the
+ * race detector confirm there is no race either.
+ *
+ *   snapshot_bench [seconds]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <Adafruit_SSD1306.h>
+#include "Obstacles.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include "Terrain.h"
+#include "UI.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Counts {
+  long steps;
+  long frames;
+  long fresh;  // Frames that drew a snapshot not drawn before
+  long torn;
+  double seconds;
+};
+
+static bool consistent(const FlightSnapshot& s) {
+  if (s.stepCount == 0) return s.trailLength == 0;
+  const TrailPoint& newest = s.trail[(s.stepCount - 1) % BUILD.trailPoints];
+  return newest.x == s.position.x && newest.y == s.position.y &&
+         s.trailLength == (int)min(s.stepCount, (uint32_t)BUILD.trailPoints);
+}
+
+// Steps the engine, starting the next launch of a fixed rotation when
+// a flight ends
+static void step(PhysicsEngine& engine, long& launches) {
+  if (engine.isSimulationComplete()) {
+    float angle = 20 + (launches * 7) % 50;
+    float velocity = 10 + (launches * 13) % 30;
+    engine.startSimulation(0, 9.81f, angle, velocity);
+    launches++;
+  }
+  engine.run(1);
+  publishFlight(engine);
+}
+
+static void drawFrame(UIRenderer& ui, Counts& counts, const FlightSnapshot*& last) {
+  const FlightSnapshot& s = flightSnapshots.acquire();
+  if (!consistent(s)) counts.torn++;
+  if (&s != last) counts.fresh++;
+  last = &s;
+  ui.setSimulationData(&s);
+  ui.render(6);  // SIMULATION_RUN
+  counts.frames++;
+}
+
+static Counts runSingle(UIRenderer& ui, double seconds) {
+  PhysicsEngine engine;
+  engine.begin();
+  flightSnapshots.begin();
+  Counts counts = {};
+  long launches = 0;
+  const FlightSnapshot* last = NULL;
+  
+  Clock::time_point start = Clock::now();
+  Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  while (Clock::now() < end) {
+    step(engine, launches);
+    counts.steps++;
+    drawFrame(ui, counts, last);
+  }
+  counts.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return counts;
+}
+
+static Counts runSplit(UIRenderer& ui, double seconds) {
+  PhysicsEngine engine;
+  engine.begin();
+  flightSnapshots.begin();
+  
+  // The consumer needs something published before its first acquire
+  long launches = 0;
+  step(engine, launches);
+  
+  std::atomic<bool> stop(false);
+  std::atomic<long> steps(1);
+  std::thread producer([&]() {
+    long taken = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      step(engine, launches);
+      taken++;
+    }
+    steps += taken;
+  });
+  
+  Counts counts = {};
+  const FlightSnapshot* last = NULL;
+  Clock::time_point start = Clock::now();
+  Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  while (Clock::now() < end) {
+    drawFrame(ui, counts, last);
+  }
+  stop = true;
+  producer.join();
+  counts.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  counts.steps = steps;
+  return counts;
+}
+
+static void report(const char* name, const Counts& c) {
+  printf("%-8s %12.0f %12.0f %12.0f %8ld\n", name, c.steps / c.seconds, c.frames / c.seconds,
+         c.fresh / c.seconds, c.torn);
+}
+
+int main(int argc, char** argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+  
+  terrain.begin();
+  obstacles.begin();
+  Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT);
+  display.begin();
+  PhysicsEngine idle;  // The renderer never reads its engine during a flight
+  idle.begin();
+  UIRenderer ui(&display, &idle);
+  ui.begin();
+  profiler.begin();  // render() times itself
+  
+  printf("%u hardware threads, %.1f s per run\n", std::thread::hardware_concurrency(), seconds);
+  printf("%-8s %12s %12s %12s %8s\n", "mode", "steps/s", "frames/s", "fresh/s", "torn");
+  Counts single = runSingle(ui, seconds);
+  report("single", single);
+  Counts split = runSplit(ui, seconds);
+  report("split", split);
+  
+  if (single.torn || split.torn) {
+    printf("torn snapshots seen\n");
+    return 1;
+  }
+  printf("no torn snapshots\n");
+  return 0;
+}
@@ -10,4 +10,12 @@
 
 // Boot animation rocket is drawn procedurally in UI.cpp
 
+// 4x4 ordered-dither thresholds for the sweep heatmap
+static const uint8_t BAYER_4X4[4][4] = {
+  { 0,  8,  2, 10},
+  {12,  4, 14,  6},
+  { 3, 11,  1,  9},
+  {15,  7, 13,  5}
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+/**
+ * Batch-solve implementation
+ */
+
+#include "Batch.h"
+
+// Longest reply: three fields of up to 12 characters plus separators
+static const uint8_t MAX_REPLY = 40;
+
+void BatchSolver::begin() {
+  active = true;
+  solved = 0;
+  errors = 0;
+  lineLength = 0;
+  head = 0;
+  tail = 0;
+  queue("OK batch\n");
+}
+
+void BatchSolver::end() {
+  char buf[16];
+  queue("OK end ");
+  queue(ultoa(solved, buf, 10));
+  queue(" ");
+  queue(ultoa(errors, buf, 10));
+  queue("\n");
+  
+  // Flush the summary before returning to the interactive loop
+  while (head != tail) {
+    drain();
+    yield();
+  }
+  active = false;
+}
+
+void BatchSolver::poll() {
+  drain();
+  
+  // Backpressure: stop reading while a reply might not fit
+  while (active && ringFree() >= MAX_REPLY && Serial.available() > 0) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+    
+    if (c == '\n') {
+      line[lineLength] = '\0';
+      handleLine();
+      lineLength = 0;
+    } else if (lineLength < BATCH_LINE_LENGTH - 1) {
+      line[lineLength++] = c;
+    }
+  }
+  
+  drain();
+}
+
+void BatchSolver::handleLine() {
+  if (lineLength == 0) return;
+  
+  if (strcmp(line, "end") == 0) {
+    end();
+    return;
+  }
+  
+  float params[4];
+  char* cursor = line;
+  for (int i = 0; i < 4; i++) {
+    char* next;
+    params[i] = strtod(cursor, &next);
+    if (next == cursor) {
+      errors++;
+      queue("ERR\n");
+      return;
+    }
+    cursor = next;
+  }
+  
+  if (params[1] < MIN_GRAVITY || params[3] < 0) {
+    errors++;
+    queue("ERR\n");
+    return;
+  }
+  
+  ShotResult result = PhysicsEngine::solve(params[0], params[1], params[2], params[3]);
+  solved++;
+  
+  char buf[16];
+  queue(dtostrf(result.range, 1, BATCH_DECIMALS, buf));
+  queue(" ");
+  queue(dtostrf(result.maxHeight, 1, BATCH_DECIMALS, buf));
+  queue(" ");
+  queue(dtostrf(result.flightTime, 1, BATCH_DECIMALS, buf));
+  queue("\n");
+}
+
+void BatchSolver::queue(const char* text) {
+  while (*text && ringFree() > 0) {
+    ring[head] = *text++;
+    head = (head + 1) % BATCH_RING_SIZE;
+  }
+}
+
+void BatchSolver::drain() {
+  int room = Serial.availableForWrite();
+  while (room > 0 && head != tail) {
+    uint16_t run = head > tail ? head - tail : BATCH_RING_SIZE - tail;
+    if (run > room) run = room;
+    
+    Serial.write((const uint8_t*)ring + tail, run);
+    tail = (tail + run) % BATCH_RING_SIZE;
+    room -= run;
+  }
+}
+
+uint16_t BatchSolver::ringFree() {
+  return (tail + BATCH_RING_SIZE - head - 1) % BATCH_RING_SIZE;
+}
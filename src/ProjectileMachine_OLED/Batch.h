@@ -0,0 +1,47 @@
+/**
+ * Headless batch-solve mode over Serial
+ *
+ * Each request line is "height gravity angle velocity"; each reply line
+ * is "range max_height flight_time". Parsing, solving and replying are
+ * interleaved a byte at a time, and input is only read while the reply
+ * ring has room, so throughput is bounded by the UART alone. A line
+ * reading "end" leaves the mode.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+
+class BatchSolver {
+  public:
+    void begin();
+    void end();
+    bool isActive() { return active; }
+    
+    // Call every loop() pass while active
+    void poll();
+    
+  private:
+    bool active;
+    unsigned long solved;
+    unsigned long errors;
+    
+    // Request line being parsed
+    char line[BATCH_LINE_LENGTH];
+    uint8_t lineLength;
+    
+    // Reply ring
+    char ring[BATCH_RING_SIZE];
+    uint16_t head;
+    uint16_t tail;
+    
+    void handleLine();
+    void queue(const char* text);
+    void drain();
+    uint16_t ringFree();
+};
+
+#endif
@@ -5,31 +5,47 @@
 #include "Beep.h"
 #include "Pins.h"
 
+static const ToneStep ERROR_PATTERN[] = {
+  {BEEP_ERROR_HZ, BEEP_ERROR / 2, false},
+  {0, 40, false},
+  {BEEP_ERROR_HZ * 3 / 4, BEEP_ERROR / 2, false}
+};
+
 void Beep::begin() {
   pinMode(BUZZER_PIN, OUTPUT);
   digitalWrite(BUZZER_PIN, LOW);
   
-  active = false;
+  queueHead = 0;
+  queueCount = 0;
+  playing = false;
+  playingBeep = false;
+  playingFrequency = 0;
+  toneEnd = 0;
   flightBeepActive = false;
-  beepStart = 0;
-  beepDuration = 0;
   lastFlightBeep = 0;
+  flightFrequency = FLIGHT_PITCH_BASE_HZ;
 }
 
 void Beep::update() {
   unsigned long now = millis();
   
-  // Handle single beep
-  if (active && now - beepStart >= beepDuration) {
-    digitalWrite(BUZZER_PIN, LOW);
-    active = false;
+  // The waveform stops on its own; this only tracks when the slot frees up
+  if (playing && (long)(now - toneEnd) >= 0) {
+    if (!BUZZER_PASSIVE) output(0, 0);
+    playing = false;
+    playingBeep = false;
+  }
+  
+  if (!playing && queueCount > 0) {
+    ToneStep step = queue[queueHead];
+    queueHead = (queueHead + 1) % BEEP_QUEUE_SIZE;
+    queueCount--;
+    start(step.frequency, step.duration, step.isBeep);
   }
   
-  // Handle flight beep
-  if (flightBeepActive && now - lastFlightBeep >= FLIGHT_BEEP_INTERVAL) {
-    digitalWrite(BUZZER_PIN, HIGH);
-    delayMicroseconds(500);
-    digitalWrite(BUZZER_PIN, LOW);
+  // Flight chirps only fill gaps between queued sounds
+  if (flightBeepActive && !playing && now - lastFlightBeep >= FLIGHT_BEEP_INTERVAL) {
+    start(flightFrequency, FLIGHT_CHIRP_MS, false);
     lastFlightBeep = now;
   }
 }
@@ -37,20 +53,82 @@ void Beep::update() {
 void Beep::beep(unsigned int duration) {
   if (!BEEPER_ENABLED) return;
   
-  digitalWrite(BUZZER_PIN, HIGH);
-  active = true;
-  beepStart = millis();
-  beepDuration = duration;
+  // Merge with a UI beep that is still sounding
+  if (playingBeep) {
+    unsigned long end = millis() + duration;
+    if ((long)(end - toneEnd) > 0) {
+      toneEnd = end;
+      output(playingFrequency, toneEnd - millis());
+    }
+    return;
+  }
+  
+  if (playing || queueCount > 0) {
+    enqueue(BEEP_TONE_HZ, duration, true);
+  } else {
+    start(BEEP_TONE_HZ, duration, true);
+  }
+}
+
+void Beep::playTone(unsigned int frequency, unsigned int duration) {
+  if (!BEEPER_ENABLED) return;
+  enqueue(frequency, duration);
+}
+
+void Beep::playPattern(const ToneStep* steps, uint8_t count) {
+  if (!BEEPER_ENABLED) return;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!enqueue(steps[i].frequency, steps[i].duration)) break;
+  }
+}
+
+void Beep::error() {
+  playPattern(ERROR_PATTERN, sizeof(ERROR_PATTERN) / sizeof(ERROR_PATTERN[0]));
 }
 
 void Beep::startFlightBeep() {
   if (!BEEPER_ENABLED) return;
   
   flightBeepActive = true;
+  flightFrequency = FLIGHT_PITCH_BASE_HZ;
   lastFlightBeep = millis();
 }
 
+void Beep::setFlightVelocity(float vy) {
+  // Rising pitch on the way up, falling on the way down
+  float frequency = FLIGHT_PITCH_BASE_HZ + vy * FLIGHT_PITCH_HZ_PER_MS;
+  flightFrequency = (uint16_t)constrain(frequency, FLIGHT_PITCH_MIN_HZ, FLIGHT_PITCH_MAX_HZ);
+}
+
 void Beep::stopFlightBeep() {
   flightBeepActive = false;
-  digitalWrite(BUZZER_PIN, LOW);
-}
\ No newline at end of file
+}
+
+bool Beep::enqueue(uint16_t frequency, uint16_t duration, bool isBeep) {
+  if (queueCount >= BEEP_QUEUE_SIZE) return false;
+  
+  queue[(queueHead + queueCount) % BEEP_QUEUE_SIZE] = {frequency, duration, isBeep};
+  queueCount++;
+  return true;
+}
+
+void Beep::start(uint16_t frequency, unsigned long duration, bool isBeep) {
+  playing = true;
+  playingBeep = isBeep;
+  playingFrequency = frequency;
+  toneEnd = millis() + duration;
+  output(frequency, duration);
+}
+
+void Beep::output(uint16_t frequency, unsigned long duration) {
+  if (BUZZER_PASSIVE) {
+    if (frequency > 0) {
+      tone(BUZZER_PIN, frequency, duration);
+    } else {
+      noTone(BUZZER_PIN);
+    }
+  } else {
+    // Active buzzer: on/off only, switched off again by update()
+    digitalWrite(BUZZER_PIN, frequency > 0 ? HIGH : LOW);
+  }
+}
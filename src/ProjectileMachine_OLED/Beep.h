@@ -1,5 +1,11 @@
 /**
  * Buzzer control for audio feedback
+ *
+ * Tones come from the core's waveform generator (tone()), which runs
+ * off a timer interrupt, so nothing here blocks loop(). UI beeps and
+ * patterns go through a small queue; a UI beep that arrives while
+ * another is sounding extends it instead of cutting it off. During
+ * flight, short chirps track the ball's vertical velocity in pitch.
  */
 
 #ifndef BEEP_H
@@ -8,22 +14,45 @@
 #include <Arduino.h>
 #include "Config.h"
 
+struct ToneStep {
+  uint16_t frequency;  // 0 is a rest
+  uint16_t duration;   // ms
+  bool isBeep;         // A UI beep, which later beeps may extend
+};
+
 class Beep {
   public:
     void begin();
     void update();
     
     void beep(unsigned int duration);
+    void playTone(unsigned int frequency, unsigned int duration);
+    void playPattern(const ToneStep* steps, uint8_t count);
+    void error();
+    
     void startFlightBeep();
+    void setFlightVelocity(float vy);
     void stopFlightBeep();
     
   private:
-    bool active;
-    unsigned long beepStart;
-    unsigned int beepDuration;
+    // Event queue
+    ToneStep queue[BEEP_QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queueCount;
+    
+    // Tone currently sounding
+    bool playing;
+    bool playingBeep;  // A UI beep, which later beeps may extend
+    uint16_t playingFrequency;
+    unsigned long toneEnd;
     
     bool flightBeepActive;
     unsigned long lastFlightBeep;
+    uint16_t flightFrequency;
+    
+    bool enqueue(uint16_t frequency, uint16_t duration, bool isBeep = false);
+    void start(uint16_t frequency, unsigned long duration, bool isBeep);
+    void output(uint16_t frequency, unsigned long duration);
 };
 
-#endif
\ No newline at end of file
+#endif
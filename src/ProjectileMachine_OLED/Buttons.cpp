@@ -6,9 +6,11 @@
 #include "Pins.h"
 
 void Buttons::begin() {
-  buttons[0] = {BUTTON_UP, HIGH, HIGH, false, 0, false, 0};
-  buttons[1] = {BUTTON_DOWN, HIGH, HIGH, false, 0, false, 0};
-  buttons[2] = {BUTTON_ENTER, HIGH, HIGH, false, 0, false, 0};
+  buttons[0] = {BUTTON_UP, HIGH, HIGH, false, 0, false, 0, false, false, false, false, 0, {0, 0}};
+  buttons[1] = {BUTTON_DOWN, HIGH, HIGH, false, 0, false, 0, false, false, false, false, 0, {0, 0}};
+  buttons[2] = {BUTTON_ENTER, HIGH, HIGH, false, 0, false, 0, true, false, false, false, 0, {0, 0}};
+  event = {0, 0};
+  nextEventId = 1;
   
   pinMode(BUTTON_UP, INPUT_PULLUP);
   pinMode(BUTTON_DOWN, INPUT_PULLUP);
@@ -19,6 +21,18 @@ void Buttons::begin() {
 
 void Buttons::update() {
   unsigned long now = millis();
+  event = {0, 0};
+  
+  // The raw level is watched every pass, so an edge is timed from when
+  // it showed up rather than from the debounced poll that accepts it
+  for (int i = 0; i < 3; i++) {
+    if (digitalRead(buttons[i].pin) == buttons[i].current) {
+      buttons[i].changing = false;
+    } else if (!buttons[i].changing) {
+      buttons[i].changing = true;
+      buttons[i].changeMicros = micros();
+    }
+  }
   
   // Debounce check
   if (now - lastUpdate < DEBOUNCE_MS) {
@@ -36,14 +50,28 @@ void Buttons::update() {
     
     // Detect press (LOW due to PULLUP)
     if (buttons[i].current == LOW && buttons[i].last == HIGH) {
-      buttons[i].pressed = true;
       buttons[i].pressTime = now;
       buttons[i].holdActive = false;
+      if (buttons[i].deferPress) {
+        buttons[i].pending = true;
+      } else {
+        buttons[i].pressed = true;
+        buttons[i].edge = stampEdge(buttons[i]);
+      }
     } else if (buttons[i].current == HIGH) {
-      buttons[i].pressed = false;
+      // A deferred press that was released early is a short press
+      if (buttons[i].pending) buttons[i].edge = stampEdge(buttons[i]);
+      buttons[i].pressed = buttons[i].pending;
+      buttons[i].pending = false;
       buttons[i].holdActive = false;
     }
     
+    // Detect long press on deferred buttons
+    if (buttons[i].pending && now - buttons[i].pressTime > LONG_PRESS_MS) {
+      buttons[i].pending = false;
+      buttons[i].longPressed = true;
+    }
+    
     // Detect hold
     if (buttons[i].current == LOW && now - buttons[i].pressTime > HOLD_START_MS) {
       buttons[i].holdActive = true;
@@ -63,6 +91,7 @@ bool Buttons::wasPressed(uint8_t button) {
   
   if (buttons[idx].pressed) {
     buttons[idx].pressed = false; // Consume the press
+    event = buttons[idx].edge;
     return true;
   }
   return false;
@@ -93,13 +122,19 @@ bool Buttons::wasLongPress(uint8_t button) {
   uint8_t idx = getButtonIndex(button);
   if (idx == 255) return false;
   
-  if (buttons[idx].pressed && millis() - buttons[idx].pressTime > LONG_PRESS_MS) {
-    buttons[idx].pressed = false;
+  if (buttons[idx].longPressed) {
+    buttons[idx].longPressed = false; // Consume the long press
     return true;
   }
   return false;
 }
 
+ButtonEvent Buttons::stampEdge(const ButtonState& button) {
+  ButtonEvent edge = {nextEventId, button.changing ? button.changeMicros : micros()};
+  if (++nextEventId == 0) nextEventId = 1;
+  return edge;
+}
+
 uint8_t Buttons::getButtonIndex(uint8_t pin) {
   for (int i = 0; i < 3; i++) {
     if (buttons[i].pin == pin) {
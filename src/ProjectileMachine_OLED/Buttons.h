@@ -8,6 +8,12 @@
 #include <Arduino.h>
 #include "Config.h"
 
+// The edge behind a reported press
+struct ButtonEvent {
+  uint16_t id;  // 0 for none
+  unsigned long atMicros;
+};
+
 class Buttons {
   public:
     void begin();
@@ -18,6 +24,10 @@ class Buttons {
     bool isHeld(uint8_t button);
     bool wasLongPress(uint8_t button);
     
+    // Edge of the press wasPressed() reported this pass; holds and long
+    // presses are not edges and carry none
+    ButtonEvent getEvent() { return event; }
+    
   private:
     struct ButtonState {
       uint8_t pin;
@@ -27,10 +37,20 @@ class Buttons {
       unsigned long pressTime;
       bool holdActive;
       unsigned long lastRepeat;
+      bool deferPress;   // Short press reported on release so a long press can win
+      bool pending;      // Down, not yet classified as short or long
+      bool longPressed;
+      bool changing;     // Raw level differs from the debounced one
+      unsigned long changeMicros;
+      ButtonEvent edge;  // Edge that made the press, press or release
     };
     
     ButtonState buttons[3];
     unsigned long lastUpdate;
+    ButtonEvent event;
+    uint16_t nextEventId;
+    
+    ButtonEvent stampEdge(const ButtonState& button);
     
     uint8_t getButtonIndex(uint8_t pin);
 };
@@ -5,19 +5,6 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-// Compatibility macros
-#ifndef min
-#define min(a,b) ((a)<(b)?(a):(b))
-#endif
-
-#ifndef max
-#define max(a,b) ((a)>(b)?(a):(b))
-#endif
-
-#ifndef constrain
-#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
-#endif
-
 // Display settings
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
@@ -31,6 +18,34 @@
 #define COEFFICIENT_OF_RESTITUTION 0.0f  // No bounce
 #define HORIZONTAL_FRICTION 1.0f  // No friction
 #define MAX_BOUNCES 0  // No bounce
+#define BOUNCE_MIN_VELOCITY 0.5f  // m/s; slower rebounds end the bouncing
+#define ROLLING_FRICTION 0.0f  // Roll-out deceleration as a share of g; 0 stops at the last impact
+
+// Terrain
+#define TERRAIN_ENABLED 1  // 0 for flat ground at y = 0
+#define TERRAIN_BUCKET_M 16.0f  // Width of an index bucket
+#define TERRAIN_MAX_BUCKETS 32
+
+// Targets and obstacles (layout in Obstacles.cpp)
+#define OBSTACLES_ENABLED 1
+#define OBSTACLE_MAX 16  // At most 32: hits are kept in a bit mask
+
+// Force model and integrator; vacuum uses the exact parabola
+#define FORCE_VACUUM 0
+#define FORCE_LINEAR_DRAG 1
+#define FORCE_QUADRATIC_DRAG 2
+#define FORCE_MODEL FORCE_VACUUM
+#define LINEAR_DRAG_K 0.05f  // 1/s
+#define QUADRATIC_DRAG_C 0.002f  // 1/m, 0.5*rho*Cd*A/m
+#define WIND_SPEED 0.0f  // m/s, positive blows downrange (drag models only)
+#define MAGNUS_SPIN 0.0f  // 1/s, positive backspin lifts (drag models only)
+#define INTEGRATOR_EULER 0
+#define INTEGRATOR_VERLET 1
+#define INTEGRATOR_RK4 2
+#define INTEGRATOR_RK45 3
+#define INTEGRATOR INTEGRATOR_RK4  // Ignored for FORCE_VACUUM
+#define RK45_TOLERANCE 1e-4f
+#define RK45_MAX_SUBSTEPS 16
 
 // Simulation parameters
 #define MIN_HEIGHT 0.0f
@@ -46,12 +61,18 @@
 #define VELOCITY_STEP 0.5f
 
 #define SIMULATION_DT 0.033f  // ~30 FPS
-
-// Performance settings
-#define MAX_PREDICTION_POINTS 60
-#define MAX_TRAIL_POINTS 8
-#define MAX_DOTTED_POINTS 60
-#define FRAME_TIME_MS 33  // ~30 FPS
+#define PHYSICS_STEP_MS 33  // Wall time per SIMULATION_DT step
+#define PHYSICS_MAX_CATCHUP 4  // Steps per update() before resyncing
+#define PHYSICS_TICKER 0  // 1: step from a Ticker instead of the loop
+
+// Build profile: path sizes and frame rate, budget-checked (Profile.h)
+#define BUILD_BALANCED 0
+#define BUILD_LOW_RAM 1
+#define BUILD_HIGH_FPS 2
+#define BUILD_PRECISION 3
+#ifndef BUILD_PROFILE
+#define BUILD_PROFILE BUILD_BALANCED
+#endif
 
 // Button timing
 #define DEBOUNCE_MS 30
@@ -67,6 +88,15 @@
 #define BEEP_LONG 500
 #define BEEP_ERROR 300
 #define FLIGHT_BEEP_INTERVAL 150
+#define BUZZER_PASSIVE 1  // Piezo driven with tone(); 0 for an on/off active buzzer
+#define BEEP_TONE_HZ 2000
+#define BEEP_ERROR_HZ 800
+#define BEEP_QUEUE_SIZE 8
+#define FLIGHT_CHIRP_MS 15
+#define FLIGHT_PITCH_BASE_HZ 1200  // Pitch at the apex
+#define FLIGHT_PITCH_HZ_PER_MS 25.0f  // Pitch change per m/s of vertical velocity
+#define FLIGHT_PITCH_MIN_HZ 300
+#define FLIGHT_PITCH_MAX_HZ 4000
 
 // UI constants
 #define GROUND_Y 56
@@ -81,7 +111,113 @@
 #define MAX_VECTOR_LENGTH 20
 #define VECTOR_ARROW_SIZE 3
 
+// Salvo
+#define SALVO_MAX_SHOTS 5
+#define SALVO_TRAIL_POINTS 6
+#define SALVO_ANGLE_STEP 7.5f  // Between neighbouring shots
+#define SALVO_VELOCITY_STEP 3.0f
+#define SALVO_DEFAULT_MODE 0  // 0 angles, 1 velocities, 2 gravities
+
+// Targeting
+#define TARGET_STEP 1.0f  // m per UP/DOWN
+#define TARGET_MIN_DISTANCE 1.0f
+#define TARGET_MAX_DISTANCE 500.0f
+#define TARGET_NEWTON_STEPS 4  // Drag models only
+#define TARGET_TOLERANCE 0.5f  // m; a drag solution further off is unreachable
+
+// Safety envelope on the angle and velocity screens
+#define ENVELOPE_DEFAULT_ON 1  // 'envelope' on the console toggles it
+#define ENVELOPE_DASH 4  // Pixels per dash period, half drawn
+
+// Ghost arcs of previous shots (how many comes from the build profile)
+#define GHOST_DASH 6  // Pixels per dash period, a third drawn
+
+// Parameter sweep heatmap
+#define SWEEP_ANGLE_CELLS 24
+#define SWEEP_VELOCITY_CELLS 12
+#define SWEEP_CELL_PX 4  // Square cells; the map is 96x48 pixels
+#define SWEEP_SCALE 10  // Cells store tenths of a metre or second
+#define SWEEP_SLICE_US 4000  // Sweep time per loop pass
+
+// Launch dispersion (Monte Carlo behind the results screen)
+#define DIST_NONE 0
+#define DIST_NORMAL 1  // Spread is sigma
+#define DIST_UNIFORM 2  // Spread is the half-width
+#define DISPERSION_ANGLE_DIST DIST_NORMAL
+#define DISPERSION_ANGLE_SPREAD 0.5f  // deg
+#define DISPERSION_VELOCITY_DIST DIST_NORMAL
+#define DISPERSION_VELOCITY_SPREAD 0.3f  // m/s
+#define DISPERSION_HEIGHT_DIST DIST_UNIFORM
+#define DISPERSION_HEIGHT_SPREAD 0.1f  // m
+#define DISPERSION_GRAVITY_DIST DIST_NONE
+#define DISPERSION_GRAVITY_SPREAD 0.0f  // m/s^2
+#define DISPERSION_SHOTS 48  // On the device
+#define DISPERSION_SEED 1
+#define DISPERSION_SLICE_US 3000  // Dispersion time per loop pass
+
 // Animation
 #define BOOT_ANIM_DURATION 2500  // 2.5 seconds
+#define BOOT_ANIM_FRAME_MS 50  // Per animation phase
+
+// Coroutine flows
+#define CORO_POOL_SIZE 4  // Frames live at once
+#define CORO_LOCALS_BYTES 16  // Per-frame locals
+
+// Persistent settings
+#define FAST_BOOT_ENABLED 1  // Restore the last session and skip the boot animation
+#define PRESET_SLOTS 3
+#define PRESET_NAME_LENGTH 10
+#define SETTINGS_JOURNAL_MAX 64  // Records before the journal is compacted
+
+// Results log
+#define RESULTS_LOG_BATCH 8  // Records buffered in RAM per flash write
+#define RESULTS_LOG_FLUSH_MS 60000  // Flush a partial batch after this long
+#define RESULTS_LOG_MAX_RECORDS 256  // Per file; the previous file is kept too
+
+// Profiling
+#define PROFILER_ENABLED 1
+#define PROFILER_MAX_STATES 16  // Room for per-state handler/render stages
+#define PROFILER_HIST_BUCKETS 8  // <32us, <64us, ... >=2ms
+#define PERF_OVERLAY_TOP_STAGES 3
+
+// Input-to-photon latency ('latency' on the console)
+#define LATENCY_MAX_STATES 16
+#define LATENCY_IN_FLIGHT 4  // Inputs handled but not yet on the panel
+#define LATENCY_BUCKET_MS 4  // Histogram bucket width
+#define LATENCY_BUCKETS 16  // <4ms, <8ms, ... >=60ms
+
+// Quality governor
+#define GOVERNOR_ENABLED 1
+#define GOVERNOR_OVERRUN_PCT 100  // Frame cost above this share of budget sheds detail
+#define GOVERNOR_HEADROOM_PCT 60  // Frame cost below this share restores detail
+#define GOVERNOR_DEGRADE_FRAMES 3
+#define GOVERNOR_RESTORE_FRAMES 30
+
+// Power management
+#define POWER_STATIC_FRAME_MS 250  // Redraw period of screens that only change on input
+#define POWER_ACTIVE_HOLD_MS 500  // Full rate this long after the last input
+#define POWER_POLL_MS DEBOUNCE_MS  // Longest wait between button polls
+#define POWER_MIN_WAIT_MS 2
+#define POWER_DIM_MS 30000  // Dim the panel after this long without input
+#define POWER_BLANK_MS 120000  // Turn the panel off after this long without input
+#define POWER_LIGHT_SLEEP 1  // Light sleep instead of delay() while dimmed
+#define POWER_MAX_STATES 16
+#define POWER_ACTIVE_MA 17.0f  // Estimated module current, radio off, CPU busy
+#define POWER_WAIT_MA 15.0f  // In delay() with the radio off
+#define POWER_SLEEP_MA 1.0f  // Forced light sleep
+
+// Serial console
+#define SERIAL_BAUD 115200
+#define SERIAL_LINE_LENGTH 32
+
+// Batch-solve mode
+#define BATCH_LINE_LENGTH 64
+#define BATCH_RING_SIZE 256
+#define BATCH_DECIMALS 4
+
+// Binary telemetry
+#define TELEMETRY_DEFAULT_ON 0  // Enable with the 'telem on' command
+#define TELEMETRY_RING_SIZE 512
+#define TELEMETRY_MAX_PAYLOAD 32
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+/**
+ * Coroutine scheduler implementation
+ */
+
+#include "Coro.h"
+
+CoroScheduler coroutines;
+
+void CoroScheduler::begin() {
+  for (int i = 0; i < CORO_POOL_SIZE; i++) {
+    frames[i].active = false;
+    frames[i].generation = 0;
+  }
+  pending = 0;
+  updateWaits();
+}
+
+CoroHandle CoroScheduler::start(CoroBody body, unsigned long now) {
+  for (int i = 0; i < CORO_POOL_SIZE; i++) {
+    CoroFrame& f = frames[i];
+    if (f.active) continue;
+    
+    f.body = body;
+    f.line = 0;
+    f.waitEvents = 0;
+    f.wakeAt = now;
+    f.generation++;
+    f.active = true;
+    CoroHandle handle = (f.generation << 8) | (i + 1);
+    resume(f, now);
+    updateWaits();
+    return f.active ? handle : 0;
+  }
+  Serial.println(F("Coroutine pool full"));
+  return 0;
+}
+
+void CoroScheduler::stop(CoroHandle handle) {
+  if (handle == 0) return;
+  CoroFrame& f = frames[(handle & 0xFF) - 1];
+  if (!f.active || f.generation != (handle >> 8)) return;
+  
+  // A new generation also tells a running body it has been stopped
+  f.active = false;
+  f.generation++;
+  updateWaits();
+}
+
+void CoroScheduler::post(uint16_t events) {
+  pending |= events;
+}
+
+void CoroScheduler::run(unsigned long now, uint16_t events) {
+  events |= pending;
+  pending = 0;
+  
+  // Nothing due and nothing awaited arrived: no frame is touched
+  if (!(events & awaited) && (!sleeping || (long)(now - nextWake) < 0)) return;
+  
+  // Frames started by a body during this pass have had their first
+  // pass already, so only the ones running beforehand are considered
+  uint8_t generations[CORO_POOL_SIZE];
+  uint32_t running = 0;
+  for (int i = 0; i < CORO_POOL_SIZE; i++) {
+    generations[i] = frames[i].generation;
+    if (frames[i].active) running |= 1UL << i;
+  }
+  
+  for (int i = 0; i < CORO_POOL_SIZE; i++) {
+    CoroFrame& f = frames[i];
+    if (!((running >> i) & 1) || !f.active || f.generation != generations[i]) continue;
+    bool due = f.waitEvents ? (f.waitEvents & events) != 0 : (long)(now - f.wakeAt) >= 0;
+    if (due) resume(f, now);
+  }
+  updateWaits();
+}
+
+int CoroScheduler::getActiveCount() {
+  int count = 0;
+  for (int i = 0; i < CORO_POOL_SIZE; i++) {
+    if (frames[i].active) count++;
+  }
+  return count;
+}
+
+void CoroScheduler::resume(CoroFrame& f, unsigned long now) {
+  uint8_t generation = f.generation;
+  CoroStatus status = f.body(f, now);
+  
+  // A body that stopped itself may already have handed its slot on
+  if (status == CORO_DONE && f.generation == generation) {
+    f.active = false;
+  }
+}
+
+void CoroScheduler::updateWaits() {
+  awaited = 0;
+  sleeping = false;
+  for (int i = 0; i < CORO_POOL_SIZE; i++) {
+    const CoroFrame& f = frames[i];
+    if (!f.active) continue;
+    if (f.waitEvents) {
+      awaited |= f.waitEvents;
+    } else if (!sleeping || (long)(f.wakeAt - nextWake) < 0) {
+      nextWake = f.wakeAt;
+      sleeping = true;
+    }
+  }
+}
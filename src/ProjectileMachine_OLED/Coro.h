@@ -0,0 +1,108 @@
+/**
+ * Stackless coroutines over a static frame pool
+ *
+ * A flow that spans many loop passes (an animation, a multi-key entry,
+ * a flight) is written as one straight function that yields until a
+ * time or an event, instead of a handler that rebuilds its progress
+ * from statics on every pass. Each body resumes at its last yield
+ * through a switch on the saved line, protothread style, so it keeps
+ * no stack between passes: what must survive a yield lives in its
+ * frame's locals. Frames come from a fixed pool and nothing touches
+ * the heap.
+ *
+ * The scheduler only resumes frames whose wake time has come or whose
+ * awaited event was posted; a pass with neither returns at once.
+ *
+ * Rules for bodies: locals that live across a yield go in the frame,
+ * a yield cannot sit inside a nested switch, and a body that stops
+ * itself (through enterState) must return without yielding again.
+ */
+
+#ifndef CORO_H
+#define CORO_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+enum CoroStatus {
+  CORO_WAITING,
+  CORO_DONE
+};
+
+struct CoroFrame;
+typedef CoroStatus (*CoroBody)(CoroFrame& frame, unsigned long now);
+
+// Slot index + 1 in the low byte, the slot's generation in the high
+// byte, so a stale handle never stops a later occupant; 0 is none
+typedef uint16_t CoroHandle;
+
+struct CoroFrame {
+  CoroBody body;
+  uint16_t line;         // Resume point, 0 before the first pass
+  uint16_t waitEvents;   // Awaited event bits; 0 waits on wakeAt
+  unsigned long wakeAt;  // millis()
+  uint8_t generation;
+  bool active;
+  uint32_t storage[(CORO_LOCALS_BYTES + 3) / 4];  // Word-aligned locals
+  
+  // The body's own locals, kept across yields
+  template <typename T>
+  T& locals() {
+    static_assert(sizeof(T) <= sizeof(storage), "Coroutine locals exceed CORO_LOCALS_BYTES");
+    return *reinterpret_cast<T*>(storage);
+  }
+};
+
+#define CORO_BEGIN(f) switch ((f).line) { case 0:
+#define CORO_END(f) } return CORO_DONE
+
+// Resume once millis() reaches 'when'
+#define CORO_SLEEP_UNTIL(f, when) \
+  do { \
+    (f).line = __LINE__; \
+    (f).wakeAt = (when); \
+    (f).waitEvents = 0; \
+    return CORO_WAITING; \
+    case __LINE__:; \
+  } while (0)
+
+// Resume on the next run() that delivers one of 'events'
+#define CORO_AWAIT(f, events) \
+  do { \
+    (f).line = __LINE__; \
+    (f).waitEvents = (events); \
+    return CORO_WAITING; \
+    case __LINE__:; \
+  } while (0)
+
+class CoroScheduler {
+  public:
+    void begin();
+    
+    // Runs the body up to its first yield; 0 if the pool is full or the
+    // body finished without yielding
+    CoroHandle start(CoroBody body, unsigned long now);
+    void stop(CoroHandle handle);
+    
+    // Events from outside the loop pass, delivered at the next run()
+    void post(uint16_t events);
+    
+    // Resumes the frames that are due at 'now' or wait on 'events'
+    void run(unsigned long now, uint16_t events);
+    
+    int getActiveCount();
+    
+  private:
+    CoroFrame frames[CORO_POOL_SIZE];
+    volatile uint16_t pending;
+    uint16_t awaited;        // Union of the events frames wait on
+    unsigned long nextWake;  // Earliest wake time, if anyone sleeps
+    bool sleeping;
+    
+    void resume(CoroFrame& f, unsigned long now);
+    void updateWaits();
+};
+
+extern CoroScheduler coroutines;
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) shared by the
+ * telemetry frames and on-flash records
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <Arduino.h>
+
+inline uint16_t crc16(const uint8_t* data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+#endif
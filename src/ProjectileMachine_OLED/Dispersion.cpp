@@ -0,0 +1,141 @@
+/**
+ * Launch dispersion implementation
+ */
+
+#include "Dispersion.h"
+#include <math.h>
+
+DispersionRun dispersion;
+
+// Steps between clock checks while a shot is in the air
+static const int STEPS_PER_CHECK = 16;
+
+void Pcg32::seed(uint64_t seed, uint64_t stream) {
+  state = 0;
+  increment = (stream << 1) | 1;
+  next();
+  state += seed;
+  next();
+  hasSpare = false;
+}
+
+uint32_t Pcg32::next() {
+  uint64_t old = state;
+  state = old * 6364136223846793005ULL + increment;
+  uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+  uint32_t rot = old >> 59;
+  return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+float Pcg32::uniform() {
+  return (next() >> 8) * (1.0f / 16777216.0f);
+}
+
+float Pcg32::normal() {
+  if (hasSpare) {
+    hasSpare = false;
+    return spare;
+  }
+  float r = sqrt(-2.0f * log(1.0f - uniform()));
+  float theta = 2.0f * M_PI * uniform();
+  spare = r * sin(theta);
+  hasSpare = true;
+  return r * cos(theta);
+}
+
+float Pcg32::sample(const Distribution& d) {
+  switch (d.kind) {
+    case DIST_NORMAL:
+      return d.spread * normal();
+    case DIST_UNIFORM:
+      return d.spread * (2.0f * uniform() - 1.0f);
+    default:
+      return 0;
+  }
+}
+
+LaunchSpread defaultLaunchSpread() {
+  LaunchSpread spread = {
+    {DISPERSION_HEIGHT_DIST, DISPERSION_HEIGHT_SPREAD},
+    {DISPERSION_GRAVITY_DIST, DISPERSION_GRAVITY_SPREAD},
+    {DISPERSION_ANGLE_DIST, DISPERSION_ANGLE_SPREAD},
+    {DISPERSION_VELOCITY_DIST, DISPERSION_VELOCITY_SPREAD}
+  };
+  return spread;
+}
+
+LaunchSettings perturbLaunch(Pcg32& rng, const LaunchSpread& spread, const LaunchSettings& nominal) {
+  // Fixed order, so a seed and stream give the same launches for a
+  // given spread; how many numbers each one consumes varies with
+  // its distribution and the normal sampler's spare
+  float height = nominal.height + rng.sample(spread.height);
+  float gravity = nominal.gravity + rng.sample(spread.gravity);
+  float angle = nominal.angle + rng.sample(spread.angle);
+  float velocity = nominal.velocity + rng.sample(spread.velocity);
+  
+  LaunchSettings launch;
+  launch.height = max(height, 0.0f);
+  launch.gravity = max(gravity, 0.01f);
+  launch.angle = constrain(angle, MIN_ANGLE, MAX_ANGLE);
+  launch.velocity = constrain(velocity, MIN_VELOCITY, MAX_VELOCITY);
+  return launch;
+}
+
+void DispersionRun::begin() {
+  engine.begin();
+  spread = defaultLaunchSpread();
+  nominal = {-1, -1, -1, -1};
+  count = 0;
+  flying = false;
+}
+
+void DispersionRun::setLaunch(const LaunchSettings& nominal) {
+  if (nominal.height == this->nominal.height && nominal.gravity == this->nominal.gravity &&
+      nominal.angle == this->nominal.angle && nominal.velocity == this->nominal.velocity) {
+    return;
+  }
+  this->nominal = nominal;
+  rng.seed(DISPERSION_SEED, 0);
+  count = 0;
+  mean = 0;
+  m2 = 0;
+  flying = false;
+}
+
+bool DispersionRun::update(unsigned long sliceMicros) {
+  unsigned long start = micros();
+  while (count < DISPERSION_SHOTS && micros() - start < sliceMicros) {
+    if (!flying) {
+      LaunchSettings launch = perturbLaunch(rng, spread, nominal);
+      engine.startSimulation(launch.height, launch.gravity, launch.angle, launch.velocity);
+      flying = true;
+    }
+    
+    engine.run(STEPS_PER_CHECK);
+    if (!engine.isSimulationComplete()) continue;
+    flying = false;
+    
+    float range = engine.getTotalRange();
+    impacts[count++] = range;
+    float delta = range - mean;
+    mean += delta / count;
+    m2 += delta * (range - mean);
+  }
+  return isComplete();
+}
+
+float DispersionRun::getCep() {
+  // Miss distances along the ground, sorted by insertion (a few dozen)
+  float miss[DISPERSION_SHOTS];
+  for (int i = 0; i < count; i++) {
+    float d = fabs(impacts[i] - mean);
+    int j = i;
+    while (j > 0 && miss[j - 1] > d) {
+      miss[j] = miss[j - 1];
+      j--;
+    }
+    miss[j] = d;
+  }
+  if (count == 0) return 0;
+  return count % 2 ? miss[count / 2] : 0.5f * (miss[count / 2 - 1] + miss[count / 2]);
+}
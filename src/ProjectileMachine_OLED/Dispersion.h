@@ -0,0 +1,91 @@
+/**
+ * Launch dispersion: Monte Carlo over perturbed launches
+ *
+ * Angle, velocity, height and gravity each get a distribution and a
+ * spread from Config.h. Samples come from PCG32, whose stream argument
+ * gives independent sequences from one seed, so a run can be split
+ * into pieces without changing its numbers. Every sample is flown by a
+ * PhysicsEngine, bounces, terrain and force model included.
+ *
+ * On the device DispersionRun flies a few dozen shots in time slices
+ * behind the results screen; host/montecarlo.cpp runs the same sampler
+ * over millions of shots on all cores.
+ */
+
+#ifndef DISPERSION_H
+#define DISPERSION_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+#include "Settings.h"
+
+struct Distribution {
+  uint8_t kind;  // DIST_NONE, DIST_NORMAL or DIST_UNIFORM
+  float spread;  // Sigma, or the half-width of a uniform
+};
+
+struct LaunchSpread {
+  Distribution height;
+  Distribution gravity;
+  Distribution angle;
+  Distribution velocity;
+};
+
+class Pcg32 {
+  public:
+    void seed(uint64_t seed, uint64_t stream);
+    uint32_t next();
+    float uniform();  // [0, 1)
+    float normal();   // Box-Muller, spare kept for the next call
+    float sample(const Distribution& d);
+    
+  private:
+    uint64_t state;
+    uint64_t increment;
+    float spare;
+    bool hasSpare;
+};
+
+// Spread configured in Config.h
+LaunchSpread defaultLaunchSpread();
+
+// Nominal launch plus noise, kept physical: height not negative,
+// gravity positive, angle and velocity inside the cannon's range
+LaunchSettings perturbLaunch(Pcg32& rng, const LaunchSpread& spread, const LaunchSettings& nominal);
+
+class DispersionRun {
+  public:
+    void begin();
+    
+    // Starts over only when the nominal launch changed
+    void setLaunch(const LaunchSettings& nominal);
+    
+    // Fly shots for up to sliceMicros; true once all are in
+    bool update(unsigned long sliceMicros);
+    bool isComplete() { return count == DISPERSION_SHOTS; }
+    
+    int getCount() { return count; }
+    float getImpact(int i) { return impacts[i]; }
+    float getMean() { return mean; }
+    float getSigma() { return count > 1 ? sqrt(m2 / (count - 1)) : 0; }
+    
+    // Median miss along the ground from the mean impact (CEP)
+    float getCep();
+    
+  private:
+    LaunchSettings nominal;
+    LaunchSpread spread;
+    Pcg32 rng;
+    PhysicsEngine engine;
+    bool flying;
+    
+    float impacts[DISPERSION_SHOTS];
+    int count;
+    float mean;
+    float m2;  // Welford sum of squared deviations
+};
+
+extern DispersionRun dispersion;
+
+#endif
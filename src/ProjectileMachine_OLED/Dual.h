@@ -0,0 +1,117 @@
+/**
+ * Forward-mode dual numbers
+ *
+ * A value carried together with its partial derivatives with respect
+ * to N inputs. Every operation applies the chain rule as it goes, so a
+ * formula written once for float, evaluated on Dual<N>, gives its value
+ * and its full gradient in the same pass, exact to rounding.
+ */
+
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <math.h>
+
+template <int N>
+struct Dual {
+  float v;     // Value
+  float d[N];  // Partial derivatives
+  
+  Dual() {}
+  Dual(float value) : v(value) {
+    for (int i = 0; i < N; i++) d[i] = 0;
+  }
+  
+  // Input i, whose derivative with respect to itself is 1
+  static Dual variable(float value, int i) {
+    Dual x(value);
+    x.d[i] = 1;
+    return x;
+  }
+};
+
+inline float valueOf(float x) { return x; }
+template <int N> inline float valueOf(const Dual<N>& x) { return x.v; }
+
+template <int N>
+inline Dual<N> operator-(const Dual<N>& a) {
+  Dual<N> r;
+  r.v = -a.v;
+  for (int i = 0; i < N; i++) r.d[i] = -a.d[i];
+  return r;
+}
+
+template <int N>
+inline Dual<N> operator+(const Dual<N>& a, const Dual<N>& b) {
+  Dual<N> r;
+  r.v = a.v + b.v;
+  for (int i = 0; i < N; i++) r.d[i] = a.d[i] + b.d[i];
+  return r;
+}
+
+template <int N>
+inline Dual<N> operator-(const Dual<N>& a, const Dual<N>& b) {
+  Dual<N> r;
+  r.v = a.v - b.v;
+  for (int i = 0; i < N; i++) r.d[i] = a.d[i] - b.d[i];
+  return r;
+}
+
+template <int N>
+inline Dual<N> operator*(const Dual<N>& a, const Dual<N>& b) {
+  Dual<N> r;
+  r.v = a.v * b.v;
+  for (int i = 0; i < N; i++) r.d[i] = a.d[i] * b.v + a.v * b.d[i];
+  return r;
+}
+
+template <int N>
+inline Dual<N> operator/(const Dual<N>& a, const Dual<N>& b) {
+  Dual<N> r;
+  float inverse = 1.0f / b.v;
+  r.v = a.v * inverse;
+  for (int i = 0; i < N; i++) r.d[i] = (a.d[i] - r.v * b.d[i]) * inverse;
+  return r;
+}
+
+// Constants on either side
+template <int N> inline Dual<N> operator+(const Dual<N>& a, float b) { return a + Dual<N>(b); }
+template <int N> inline Dual<N> operator+(float a, const Dual<N>& b) { return Dual<N>(a) + b; }
+template <int N> inline Dual<N> operator-(const Dual<N>& a, float b) { return a - Dual<N>(b); }
+template <int N> inline Dual<N> operator-(float a, const Dual<N>& b) { return Dual<N>(a) - b; }
+template <int N> inline Dual<N> operator/(float a, const Dual<N>& b) { return Dual<N>(a) / b; }
+
+template <int N>
+inline Dual<N> operator*(const Dual<N>& a, float b) {
+  Dual<N> r;
+  r.v = a.v * b;
+  for (int i = 0; i < N; i++) r.d[i] = a.d[i] * b;
+  return r;
+}
+
+template <int N> inline Dual<N> operator*(float a, const Dual<N>& b) { return b * a; }
+template <int N> inline Dual<N> operator/(const Dual<N>& a, float b) { return a * (1.0f / b); }
+
+// Comparisons look at the value only
+template <int N> inline bool operator>(const Dual<N>& a, float b) { return a.v > b; }
+template <int N> inline bool operator>=(const Dual<N>& a, float b) { return a.v >= b; }
+
+// Functions, with the derivative of the outer function applied
+template <int N>
+inline Dual<N> chain(const Dual<N>& a, float value, float derivative) {
+  Dual<N> r;
+  r.v = value;
+  for (int i = 0; i < N; i++) r.d[i] = a.d[i] * derivative;
+  return r;
+}
+
+template <int N>
+inline Dual<N> sqrt(const Dual<N>& a) {
+  float root = sqrt(a.v);
+  return chain(a, root, root > 0 ? 0.5f / root : 0.0f);
+}
+
+template <int N> inline Dual<N> sin(const Dual<N>& a) { return chain(a, sin(a.v), cos(a.v)); }
+template <int N> inline Dual<N> cos(const Dual<N>& a) { return chain(a, cos(a.v), -sin(a.v)); }
+
+#endif
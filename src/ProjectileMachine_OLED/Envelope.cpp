@@ -0,0 +1,32 @@
+/**
+ * Safety envelope implementation
+ */
+
+#include "Envelope.h"
+#include "Terrain.h"
+#include <math.h>
+
+SafetyEnvelope envelope;
+
+void SafetyEnvelope::begin() {
+  enabled = ENVELOPE_DEFAULT_ON;
+  h0 = g = velocity = -1;
+}
+
+void SafetyEnvelope::update(float h0, float g, float velocity) {
+  if (h0 == this->h0 && g == this->g && velocity == this->velocity) return;
+  this->h0 = h0;
+  this->g = g;
+  this->velocity = velocity;
+  
+  float v2 = velocity * velocity;
+  apex = h0 + v2 / (2.0f * g);
+  curvature = g / (2.0f * v2);
+  
+  // The envelope is the level shot from its apex; where that lands is
+  // the farthest point any angle reaches
+  TerrainHit hit = terrain.intersect(0, apex, velocity, 0, g);
+  maxRange = hit.x;
+  maxRangeHeight = hit.y;
+  optimalAngle = atan2(v2, g * maxRange) * 180.0f / M_PI;
+}
@@ -0,0 +1,57 @@
+/**
+ * Safety envelope of every shot at the current velocity
+ *
+ * For launch speed v from height h0, all vacuum trajectories lie under
+ * the parabola y = h0 + v²/2g - g·x²/2v². It is itself a ballistic arc
+ * fired level from its apex, so its ground contact comes from the same
+ * exact terrain intersection as a shot: that point is the maximum
+ * range, and tanθ = v²/(g·x) is the angle that reaches it. Everything
+ * is closed form in (h0, g, v); the launch angle does not enter.
+ * It bounds vacuum shots only: under a drag model a tailwind or Magnus
+ * lift can carry a shot past it, so it is then shown as the vacuum case.
+ */
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "ForceModels.h"
+
+class SafetyEnvelope {
+  public:
+    void begin();
+    
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() { return enabled; }
+    
+    // Recompute for a launch; unchanged parameters cost a compare
+    void update(float h0, float g, float velocity);
+    
+    // Envelope height at distance x from the cannon
+    float heightAt(float x) { return apex - curvature * x * x; }
+    
+    float getApex() { return apex; }
+    float getMaxRange() { return maxRange; }
+    float getMaxRangeHeight() { return maxRangeHeight; }
+    float getOptimalAngle() { return optimalAngle; }
+    
+    // Whether every shot of the active force model stays under it
+    static bool isUpperBound() { return ActiveForceModel::closedForm; }
+    
+  private:
+    bool enabled;
+    float h0;
+    float g;
+    float velocity;
+    
+    float apex;       // h0 + v²/2g, straight up
+    float curvature;  // g/2v²
+    float maxRange;
+    float maxRangeHeight;
+    float optimalAngle;  // Degrees
+};
+
+extern SafetyEnvelope envelope;
+
+#endif
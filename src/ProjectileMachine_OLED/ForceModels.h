@@ -0,0 +1,101 @@
+/**
+ * Force models for the projectile
+ *
+ * A model is a small struct whose call operator returns the
+ * acceleration from everything except gravity for a given state;
+ * integrators add gravity themselves. Models set closedForm when they
+ * add nothing, so the vacuum case can skip integration entirely.
+ */
+
+#ifndef FORCE_MODELS_H
+#define FORCE_MODELS_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "Config.h"
+
+struct BodyState {
+  float x, y;
+  float vx, vy;
+};
+
+struct Accel {
+  float x, y;
+};
+
+// No forces besides gravity: the parabola is exact
+struct Vacuum {
+  static constexpr bool closedForm = true;
+  Accel operator()(const BodyState&) const { return {0, 0}; }
+};
+
+// Drag proportional to velocity, k in 1/s
+struct LinearDrag {
+  static constexpr bool closedForm = false;
+  float k;
+  Accel operator()(const BodyState& s) const { return {-k * s.vx, -k * s.vy}; }
+};
+
+// Drag proportional to speed squared, c = ½·ρ·Cd·A / m in 1/m
+struct QuadraticDrag {
+  static constexpr bool closedForm = false;
+  float c;
+  Accel operator()(const BodyState& s) const {
+    float speed = sqrtf(s.vx * s.vx + s.vy * s.vy);
+    return {-c * speed * s.vx, -c * speed * s.vy};
+  }
+};
+
+// Constant horizontal wind; the drag model sees the air-relative velocity
+template <class Drag>
+struct Wind {
+  static constexpr bool closedForm = false;
+  Drag drag;
+  float speed;  // m/s, positive blows downrange
+  Accel operator()(const BodyState& s) const {
+    BodyState relative = {s.x, s.y, s.vx - speed, s.vy};
+    return drag(relative);
+  }
+};
+
+// Spin lift perpendicular to the velocity, spin in 1/s (positive is backspin)
+struct Magnus {
+  static constexpr bool closedForm = false;
+  float spin;
+  Accel operator()(const BodyState& s) const { return {-spin * s.vy, spin * s.vx}; }
+};
+
+// Sum of two models
+template <class A, class B>
+struct Combined {
+  static constexpr bool closedForm = A::closedForm && B::closedForm;
+  A a;
+  B b;
+  Accel operator()(const BodyState& s) const {
+    Accel first = a(s);
+    Accel second = b(s);
+    return {first.x + second.x, first.y + second.y};
+  }
+};
+
+// Model selected in Config.h
+#if FORCE_MODEL == FORCE_VACUUM
+typedef Vacuum ActiveForceModel;
+inline ActiveForceModel makeForceModel() { return Vacuum(); }
+#else
+#if FORCE_MODEL == FORCE_LINEAR_DRAG
+typedef LinearDrag ActiveDrag;
+inline ActiveDrag makeDrag() { return {LINEAR_DRAG_K}; }
+#elif FORCE_MODEL == FORCE_QUADRATIC_DRAG
+typedef QuadraticDrag ActiveDrag;
+inline ActiveDrag makeDrag() { return {QUADRATIC_DRAG_C}; }
+#else
+#error "Unknown FORCE_MODEL"
+#endif
+typedef Combined<Wind<ActiveDrag>, Magnus> ActiveForceModel;
+inline ActiveForceModel makeForceModel() {
+  return {{makeDrag(), WIND_SPEED}, {MAGNUS_SPIN}};
+}
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * Ghost arcs implementation
+ */
+
+#include "Ghosts.h"
+#include "Physics.h"
+
+GhostShots ghosts;
+
+// Rounded to the nearest step and held inside the field's range
+static long quantize(float value, float scale, long lo, long hi) {
+  return constrain(lroundf(value * scale), lo, hi);
+}
+
+void GhostShots::begin() {
+  newest = 0;
+  count = 0;
+}
+
+void GhostShots::record(float height, float gravity, float angle, float velocity, float endTime) {
+  float vx, vy;
+  PhysicsEngine::launchVelocity(angle, velocity, vx, vy);
+  
+  newest = (newest + 1) % BUILD.ghostShots;
+  GhostArc& arc = arcs[newest];
+  arc.height = quantize(height, 100, INT16_MIN, INT16_MAX);
+  arc.vx = quantize(vx, 100, 0, INT16_MAX);
+  arc.vy = quantize(vy, 100, INT16_MIN, INT16_MAX);
+  arc.gravity = quantize(gravity, 1000, 1, UINT16_MAX);
+  arc.endTime = quantize(endTime, 100, 0, UINT16_MAX);
+  if (count < BUILD.ghostShots) count++;
+}
+
+const GhostArc& GhostShots::get(int i) {
+  return arcs[(newest - i + BUILD.ghostShots) % BUILD.ghostShots];
+}
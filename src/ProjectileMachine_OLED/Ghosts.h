@@ -0,0 +1,45 @@
+/**
+ * Ghost arcs of the last shots
+ *
+ * Each finished shot is kept as the coefficients of its first arc from
+ * the cannon: launch height, velocity components, gravity and the time
+ * the arc ends, in fixed point. That is 10 bytes a shot instead of a
+ * buffer of path points, and the arc redraws exactly at any camera
+ * position. The renderer shows them as faint dashed arcs behind the
+ * prediction, so the next shot can be corrected against the last ones.
+ */
+
+#ifndef GHOSTS_H
+#define GHOSTS_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Profile.h"
+
+struct GhostArc {
+  int16_t height;     // cm
+  int16_t vx;         // cm/s
+  int16_t vy;         // cm/s
+  uint16_t gravity;   // mm/s²
+  uint16_t endTime;   // cs
+};
+
+class GhostShots {
+  public:
+    void begin();
+    
+    // A finished shot and the time its first arc ended
+    void record(float height, float gravity, float angle, float velocity, float endTime);
+    
+    int getCount() { return count; }
+    const GhostArc& get(int i);  // 0 is the newest
+    
+  private:
+    GhostArc arcs[BUILD.ghostShots];
+    int newest;
+    int count;
+};
+
+extern GhostShots ghosts;
+
+#endif
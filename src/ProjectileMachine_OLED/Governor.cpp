@@ -0,0 +1,47 @@
+/**
+ * Quality governor implementation
+ */
+
+#include "Governor.h"
+#include "Profile.h"
+
+void QualityGovernor::begin() {
+  level = QUALITY_FULL;
+  overrunFrames = 0;
+  headroomFrames = 0;
+  levelChanges = 0;
+}
+
+void QualityGovernor::reportFrame(unsigned long frameMicros) {
+  if (!GOVERNOR_ENABLED) return;
+  
+  // Always judged against the full-rate budget, so half rate only
+  // restores once a full-rate frame would fit again
+  unsigned long budget = BUILD.frameTimeMs * 1000UL;
+  
+  if (frameMicros > budget * GOVERNOR_OVERRUN_PCT / 100) {
+    headroomFrames = 0;
+    if (++overrunFrames >= GOVERNOR_DEGRADE_FRAMES && level < QUALITY_LEVELS - 1) {
+      setLevel(level + 1);
+    }
+  } else if (frameMicros < budget * GOVERNOR_HEADROOM_PCT / 100) {
+    overrunFrames = 0;
+    if (++headroomFrames >= GOVERNOR_RESTORE_FRAMES && level > QUALITY_FULL) {
+      setLevel(level - 1);
+    }
+  } else {
+    // Inside the band: hold the current level
+    overrunFrames = 0;
+    headroomFrames = 0;
+  }
+}
+
+void QualityGovernor::setLevel(uint8_t newLevel) {
+  level = newLevel;
+  overrunFrames = 0;
+  headroomFrames = 0;
+  levelChanges++;
+  
+  Serial.print(F("Quality level: "));
+  Serial.println(level);
+}
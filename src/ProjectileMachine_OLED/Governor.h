@@ -0,0 +1,41 @@
+/**
+ * Adaptive quality governor that keeps rendering inside the frame budget
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Each level sheds the work of the ones before it as well
+enum QualityLevel {
+  QUALITY_FULL,
+  QUALITY_NO_VECTORS,   // Skip velocity vectors
+  QUALITY_THIN_PATHS,   // Sparser dotted path, trail and prediction
+  QUALITY_NO_TEXTURE,   // Plain ground line
+  QUALITY_HALF_RATE,    // Render every other frame slot
+  QUALITY_LEVELS
+};
+
+class QualityGovernor {
+  public:
+    void begin();
+    
+    // Cost of a loop() pass that rendered, in microseconds
+    void reportFrame(unsigned long frameMicros);
+    
+    uint8_t getLevel() { return level; }
+    uint8_t getRenderDivider() { return level >= QUALITY_HALF_RATE ? 2 : 1; }
+    unsigned long getLevelChanges() { return levelChanges; }
+    
+  private:
+    uint8_t level;
+    uint8_t overrunFrames;
+    uint8_t headroomFrames;
+    unsigned long levelChanges;
+    
+    void setLevel(uint8_t newLevel);
+};
+
+#endif
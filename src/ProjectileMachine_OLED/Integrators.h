@@ -0,0 +1,171 @@
+/**
+ * Fixed-step integrators for the force models
+ *
+ * Each integrator is a struct with a static step() template, selected
+ * at compile time. advance() bypasses them for closed-form models,
+ * where a constant-gravity step is exact.
+ */
+
+#ifndef INTEGRATORS_H
+#define INTEGRATORS_H
+
+#include "ForceModels.h"
+
+// State derivative (velocity, acceleration including gravity)
+template <class Model>
+inline BodyState derivative(const BodyState& s, float g, const Model& model) {
+  Accel a = model(s);
+  return {s.vx, s.vy, a.x, a.y - g};
+}
+
+// s + d·h
+inline BodyState offsetState(const BodyState& s, const BodyState& d, float h) {
+  return {s.x + d.x * h, s.y + d.y * h, s.vx + d.vx * h, s.vy + d.vy * h};
+}
+
+// First order, one evaluation: velocity first, then position
+struct SemiImplicitEuler {
+  static constexpr int evaluations = 1;
+  template <class Model>
+  static void step(BodyState& s, float dt, float g, const Model& model) {
+    Accel a = model(s);
+    s.vx += a.x * dt;
+    s.vy += (a.y - g) * dt;
+    s.x += s.vx * dt;
+    s.y += s.vy * dt;
+  }
+};
+
+// Velocity Verlet, second order; velocity-dependent forces use a predicted velocity
+struct Verlet {
+  static constexpr int evaluations = 2;
+  template <class Model>
+  static void step(BodyState& s, float dt, float g, const Model& model) {
+    Accel a = model(s);
+    a.y -= g;
+    BodyState next = {s.x + s.vx * dt + 0.5f * a.x * dt * dt,
+                      s.y + s.vy * dt + 0.5f * a.y * dt * dt,
+                      s.vx + a.x * dt,
+                      s.vy + a.y * dt};
+    Accel b = model(next);
+    b.y -= g;
+    s.x = next.x;
+    s.y = next.y;
+    s.vx += 0.5f * (a.x + b.x) * dt;
+    s.vy += 0.5f * (a.y + b.y) * dt;
+  }
+};
+
+// Classic fourth-order Runge-Kutta
+struct RK4 {
+  static constexpr int evaluations = 4;
+  template <class Model>
+  static void step(BodyState& s, float dt, float g, const Model& model) {
+    BodyState k1 = derivative(s, g, model);
+    BodyState k2 = derivative(offsetState(s, k1, dt * 0.5f), g, model);
+    BodyState k3 = derivative(offsetState(s, k2, dt * 0.5f), g, model);
+    BodyState k4 = derivative(offsetState(s, k3, dt), g, model);
+    float h = dt / 6.0f;
+    s.x += (k1.x + 2 * k2.x + 2 * k3.x + k4.x) * h;
+    s.y += (k1.y + 2 * k2.y + 2 * k3.y + k4.y) * h;
+    s.vx += (k1.vx + 2 * k2.vx + 2 * k3.vx + k4.vx) * h;
+    s.vy += (k1.vy + 2 * k2.vy + 2 * k3.vy + k4.vy) * h;
+  }
+};
+
+// Dormand-Prince 5(4) with adaptive substeps inside each fixed step
+struct RK45 {
+  static constexpr int evaluations = 7;  // Per trial substep
+  template <class Model>
+  static void step(BodyState& s, float dt, float g, const Model& model) {
+    float remaining = dt;
+    float h = dt;
+    for (int i = 0; i < RK45_MAX_SUBSTEPS && remaining > 0; i++) {
+      // The last substep allowed finishes the step regardless of error
+      bool last = i == RK45_MAX_SUBSTEPS - 1;
+      if (h > remaining || last) h = remaining;
+      BodyState next;
+      float error = attempt(s, h, g, model, next);
+      if (error <= 1.0f || last) {
+        s = next;
+        remaining -= h;
+      }
+      // Standard step-size controller, growth limited to 0.2x..5x
+      float scale = error > 0 ? 0.9f * powf(error, -0.2f) : 5.0f;
+      h *= scale < 0.2f ? 0.2f : (scale > 5.0f ? 5.0f : scale);
+    }
+  }
+  
+  // One trial step; returns the error relative to RK45_TOLERANCE
+  template <class Model>
+  static float attempt(const BodyState& s, float h, float g, const Model& model, BodyState& out) {
+    BodyState k1 = derivative(s, g, model);
+    BodyState k2 = derivative(combine(s, h, k1, 1.0f / 5), g, model);
+    BodyState k3 = derivative(combine(s, h, k1, 3.0f / 40, k2, 9.0f / 40), g, model);
+    BodyState k4 = derivative(combine(s, h, k1, 44.0f / 45, k2, -56.0f / 15, k3, 32.0f / 9), g, model);
+    BodyState k5 = derivative(combine(s, h, k1, 19372.0f / 6561, k2, -25360.0f / 2187,
+                                      k3, 64448.0f / 6561, k4, -212.0f / 729), g, model);
+    BodyState k6 = derivative(combine(s, h, k1, 9017.0f / 3168, k2, -355.0f / 33,
+                                      k3, 46732.0f / 5247, k4, 49.0f / 176,
+                                      k5, -5103.0f / 18656), g, model);
+    out = combine(s, h, k1, 35.0f / 384, k3, 500.0f / 1113, k4, 125.0f / 192,
+                  k5, -2187.0f / 6784, k6, 11.0f / 84);
+    BodyState k7 = derivative(out, g, model);
+    
+    // Difference between the fifth- and embedded fourth-order solutions
+    BodyState diff = combine({0, 0, 0, 0}, h, k1, 35.0f / 384 - 5179.0f / 57600,
+                             k3, 500.0f / 1113 - 7571.0f / 16695,
+                             k4, 125.0f / 192 - 393.0f / 640,
+                             k5, -2187.0f / 6784 + 92097.0f / 339200,
+                             k6, 11.0f / 84 - 187.0f / 2100, k7, -1.0f / 40);
+    float error = 0;
+    error = fmaxf(error, fabsf(diff.x) / (RK45_TOLERANCE * (1 + fabsf(out.x))));
+    error = fmaxf(error, fabsf(diff.y) / (RK45_TOLERANCE * (1 + fabsf(out.y))));
+    error = fmaxf(error, fabsf(diff.vx) / (RK45_TOLERANCE * (1 + fabsf(out.vx))));
+    error = fmaxf(error, fabsf(diff.vy) / (RK45_TOLERANCE * (1 + fabsf(out.vy))));
+    return error;
+  }
+  
+  // s + h·Σ(weight·k), over up to six stages
+  static BodyState combine(const BodyState& s, float h,
+                           const BodyState& k1, float w1,
+                           const BodyState& k2 = {0, 0, 0, 0}, float w2 = 0,
+                           const BodyState& k3 = {0, 0, 0, 0}, float w3 = 0,
+                           const BodyState& k4 = {0, 0, 0, 0}, float w4 = 0,
+                           const BodyState& k5 = {0, 0, 0, 0}, float w5 = 0,
+                           const BodyState& k6 = {0, 0, 0, 0}, float w6 = 0) {
+    BodyState r = s;
+    r.x += h * (k1.x * w1 + k2.x * w2 + k3.x * w3 + k4.x * w4 + k5.x * w5 + k6.x * w6);
+    r.y += h * (k1.y * w1 + k2.y * w2 + k3.y * w3 + k4.y * w4 + k5.y * w5 + k6.y * w6);
+    r.vx += h * (k1.vx * w1 + k2.vx * w2 + k3.vx * w3 + k4.vx * w4 + k5.vx * w5 + k6.vx * w6);
+    r.vy += h * (k1.vy * w1 + k2.vy * w2 + k3.vy * w3 + k4.vy * w4 + k5.vy * w5 + k6.vy * w6);
+    return r;
+  }
+};
+
+// One step of any model; closed-form models take the exact parabola step
+template <class Integrator, class Model>
+inline void advance(BodyState& s, float dt, float g, const Model& model) {
+  if constexpr (Model::closedForm) {
+    s.x += s.vx * dt;
+    s.y += s.vy * dt - 0.5f * g * dt * dt;
+    s.vy -= g * dt;
+  } else {
+    Integrator::step(s, dt, g, model);
+  }
+}
+
+// Integrator selected in Config.h
+#if INTEGRATOR == INTEGRATOR_EULER
+typedef SemiImplicitEuler ActiveIntegrator;
+#elif INTEGRATOR == INTEGRATOR_VERLET
+typedef Verlet ActiveIntegrator;
+#elif INTEGRATOR == INTEGRATOR_RK4
+typedef RK4 ActiveIntegrator;
+#elif INTEGRATOR == INTEGRATOR_RK45
+typedef RK45 ActiveIntegrator;
+#else
+#error "Unknown INTEGRATOR"
+#endif
+
+#endif
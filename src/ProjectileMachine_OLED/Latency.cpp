@@ -0,0 +1,145 @@
+/**
+ * Input-to-photon latency implementation
+ */
+
+#include "Latency.h"
+
+LatencyTracker latency;
+
+void LatencyTracker::begin() {
+  reset();
+}
+
+void LatencyTracker::reset() {
+  inFlightCount = 0;
+  dropped = 0;
+  for (int i = 0; i < LATENCY_MAX_STATES; i++) {
+    StateStats& s = stats[i];
+    s.count = 0;
+    s.minMicros = 0xFFFFFFFF;
+    s.maxMicros = 0;
+    s.handleMicros = 0;
+    s.renderMicros = 0;
+    s.flushMicros = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+      s.histogram[b] = 0;
+    }
+  }
+}
+
+void LatencyTracker::handled(const ButtonEvent& event, uint8_t state, unsigned long now) {
+  if (event.id == 0 || state >= LATENCY_MAX_STATES) return;
+  
+  // The panel never caught up with the oldest; let it go
+  if (inFlightCount == LATENCY_IN_FLIGHT) {
+    for (int i = 1; i < LATENCY_IN_FLIGHT; i++) {
+      inFlight[i - 1] = inFlight[i];
+    }
+    inFlightCount--;
+    dropped++;
+  }
+  inFlight[inFlightCount++] = {event.id, state, false, event.atMicros, now, 0};
+}
+
+void LatencyTracker::frameRendered(unsigned long now) {
+  for (int i = 0; i < inFlightCount; i++) {
+    if (inFlight[i].rendered) continue;
+    inFlight[i].rendered = true;
+    inFlight[i].renderedMicros = now;
+  }
+}
+
+void LatencyTracker::frameFlushed(unsigned long now) {
+  // Inputs handled after the frame was drawn wait for the next one
+  int kept = 0;
+  for (int i = 0; i < inFlightCount; i++) {
+    if (inFlight[i].rendered) {
+      complete(inFlight[i], now);
+    } else {
+      inFlight[kept++] = inFlight[i];
+    }
+  }
+  inFlightCount = kept;
+}
+
+void LatencyTracker::complete(const InFlight& e, unsigned long flushedMicros) {
+  StateStats& s = stats[e.state];
+  if (s.count == 0xFFFF) return;
+  
+  uint32_t total = flushedMicros - e.edgeMicros;
+  if (total < s.minMicros) s.minMicros = total;
+  if (total > s.maxMicros) s.maxMicros = total;
+  s.count++;
+  s.handleMicros += e.handledMicros - e.edgeMicros;
+  s.renderMicros += e.renderedMicros - e.handledMicros;
+  s.flushMicros += flushedMicros - e.renderedMicros;
+  
+  uint32_t bucket = total / (LATENCY_BUCKET_MS * 1000UL);
+  s.histogram[min(bucket, (uint32_t)(LATENCY_BUCKETS - 1))]++;
+}
+
+uint16_t LatencyTracker::getCount(uint8_t state) {
+  return state < LATENCY_MAX_STATES ? stats[state].count : 0;
+}
+
+float LatencyTracker::getAverageMs(uint8_t state) {
+  if (getCount(state) == 0) return 0;
+  const StateStats& s = stats[state];
+  return (float)(s.handleMicros + s.renderMicros + s.flushMicros) / s.count / 1000.0f;
+}
+
+float LatencyTracker::getPercentileMs(uint8_t state, uint8_t percent) {
+  if (getCount(state) == 0) return 0;
+  const StateStats& s = stats[state];
+  
+  // Upper edge of the bucket holding the percentile, capped at the worst
+  // case; the open last bucket has only the worst case
+  uint32_t rank = ((uint32_t)s.count * percent + 99) / 100;
+  uint32_t seen = 0;
+  float maxMs = s.maxMicros / 1000.0f;
+  for (int b = 0; b < LATENCY_BUCKETS - 1; b++) {
+    seen += s.histogram[b];
+    if (seen >= rank) return min((float)((b + 1) * LATENCY_BUCKET_MS), maxMs);
+  }
+  return maxMs;
+}
+
+void LatencyTracker::dump(Print& out) {
+  out.print(F("state count min_ms avg_ms p95_ms max_ms | handle render flush avg_ms | hist per "));
+  out.print(LATENCY_BUCKET_MS);
+  out.println(F("ms"));
+  
+  for (uint8_t i = 0; i < LATENCY_MAX_STATES; i++) {
+    const StateStats& s = stats[i];
+    if (s.count == 0) continue;
+    
+    out.print(i);
+    out.print(' ');
+    out.print(s.count);
+    out.print(' ');
+    out.print(s.minMicros / 1000.0f, 1);
+    out.print(' ');
+    out.print(getAverageMs(i), 1);
+    out.print(' ');
+    out.print(getPercentileMs(i, 95), 1);
+    out.print(' ');
+    out.print(s.maxMicros / 1000.0f, 1);
+    out.print(F(" |"));
+    const uint64_t parts[] = {s.handleMicros, s.renderMicros, s.flushMicros};
+    for (int p = 0; p < 3; p++) {
+      out.print(' ');
+      out.print((float)parts[p] / s.count / 1000.0f, 1);
+    }
+    out.print(F(" |"));
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+      out.print(' ');
+      out.print(s.histogram[b]);
+    }
+    out.println();
+  }
+  
+  if (dropped > 0) {
+    out.print(F("dropped "));
+    out.println(dropped);
+  }
+}
@@ -0,0 +1,72 @@
+/**
+ * Input-to-photon latency
+ *
+ * Follows each button edge from the poll that saw it, through the state
+ * handler that acted on it, to the first frame drawn after that and the
+ * display() that put the frame on the panel. Inputs handled in the same
+ * pass ride the same frame. The spread from edge to flush is kept per
+ * handling state as a histogram with min/avg/max, together with where
+ * the time went: waiting for the handler, drawing and flushing.
+ *
+ * Buttons times an edge from the first loop pass that read the new
+ * level, so the debounce poll interval is counted. An edge that comes
+ * during a pass (a flush, say) or while the loop waits is seen at the
+ * next pass, so up to one pass of it is not.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Buttons.h"
+
+class LatencyTracker {
+  public:
+    void begin();
+    void reset();
+    
+    // A state handler acted on a button edge
+    void handled(const ButtonEvent& event, uint8_t state, unsigned long now);
+    
+    // Frame drawn, then flushed; call from render() around display()
+    void frameRendered(unsigned long now);
+    void frameFlushed(unsigned long now);
+    
+    uint16_t getCount(uint8_t state);
+    float getAverageMs(uint8_t state);
+    float getPercentileMs(uint8_t state, uint8_t percent);
+    
+    void dump(Print& out);
+    
+  private:
+    struct InFlight {
+      uint16_t id;
+      uint8_t state;
+      bool rendered;
+      unsigned long edgeMicros;
+      unsigned long handledMicros;
+      unsigned long renderedMicros;
+    };
+    
+    struct StateStats {
+      uint16_t count;
+      uint32_t minMicros;
+      uint32_t maxMicros;
+      uint64_t handleMicros;  // Edge to handler
+      uint64_t renderMicros;  // Handler to frame drawn
+      uint64_t flushMicros;   // Frame drawn to flush done
+      uint16_t histogram[LATENCY_BUCKETS];
+    };
+    
+    InFlight inFlight[LATENCY_IN_FLIGHT];
+    uint8_t inFlightCount;
+    unsigned long dropped;
+    StateStats stats[LATENCY_MAX_STATES];
+    
+    void complete(const InFlight& e, unsigned long flushedMicros);
+};
+
+extern LatencyTracker latency;
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * Targets and obstacles implementation
+ */
+
+#include "Obstacles.h"
+#include <math.h>
+
+ObstacleField obstacles;
+
+// A balloon over the pad, a pole and a bar over the valley, a board on
+// the platform and a far balloon over the plateau
+static const ObstacleDef LAYOUT[] = {
+  {SHAPE_CIRCLE, ROLE_TARGET, 200, 140, 20, 0},
+  {SHAPE_RECT, ROLE_OBSTACLE, 800, 0, 10, 100},
+  {SHAPE_RECT, ROLE_OBSTACLE, 1180, 150, 100, 15},
+  {SHAPE_RECT, ROLE_TARGET, 1570, 100, 30, 40},
+  {SHAPE_CIRCLE, ROLE_TARGET, 2600, 200, 30, 0}
+};
+
+// Bernstein subdivisions; 2^-20 of the interval is below float resolution
+static const int ROOT_DEPTH = 20;
+
+// Slack for a root landing exactly on a rectangle's corner
+static const float EDGE_EPSILON = 1e-4f;
+
+void ObstacleField::begin() {
+  count = 0;
+  targetMask = 0;
+  if (!OBSTACLES_ENABLED) return;
+  
+  int defined = min((int)(sizeof(LAYOUT) / sizeof(LAYOUT[0])), OBSTACLE_MAX);
+  for (int i = 0; i < defined; i++) {
+    const ObstacleDef& d = LAYOUT[i];
+    Obstacle o;
+    o.shape = d.shape;
+    o.role = d.role;
+    if (d.shape == SHAPE_CIRCLE) {
+      o.x0 = (d.x - d.w) * 0.1f;
+      o.y0 = (d.y - d.w) * 0.1f;
+      o.x1 = (d.x + d.w) * 0.1f;
+      o.y1 = (d.y + d.w) * 0.1f;
+    } else {
+      o.x0 = d.x * 0.1f;
+      o.y0 = d.y * 0.1f;
+      o.x1 = (d.x + d.w) * 0.1f;
+      o.y1 = (d.y + d.h) * 0.1f;
+    }
+    
+    // Insert sorted by left edge
+    int j = count++;
+    while (j > 0 && shapes[j - 1].x0 > o.x0) {
+      shapes[j] = shapes[j - 1];
+      j--;
+    }
+    shapes[j] = o;
+  }
+  
+  for (int i = 0; i < count; i++) {
+    if (shapes[i].role == ROLE_TARGET) targetMask |= 1UL << i;
+    rightReach[i] = i > 0 ? max(rightReach[i - 1], shapes[i].x1) : shapes[i].x1;
+  }
+}
+
+bool ObstacleField::sweep(float x, float y, float vx, float vy, float ax, float ay,
+                          float duration, uint32_t skipMask, ObstacleHit& hit) {
+  if (count == 0 || duration <= 0) return false;
+  
+  // x-range covered by the step, including a turning point inside it
+  float xEnd = x + vx * duration + 0.5f * ax * duration * duration;
+  float lo = min(x, xEnd);
+  float hi = max(x, xEnd);
+  if (ax != 0) {
+    float turn = -vx / ax;
+    if (turn > 0 && turn < duration) {
+      float xTurn = x + vx * turn + 0.5f * ax * turn * turn;
+      lo = min(lo, xTurn);
+      hi = max(hi, xTurn);
+    }
+  }
+  
+  // Shapes from 'end' on start right of the range; walking left, stop
+  // once no earlier shape reaches as far as its left end
+  int first = 0;
+  int end = count;
+  while (first < end) {
+    int mid = (first + end) / 2;
+    if (shapes[mid].x0 <= hi) first = mid + 1;
+    else end = mid;
+  }
+  
+  bool found = false;
+  for (int i = end - 1; i >= 0 && rightReach[i] >= lo; i--) {
+    if ((skipMask >> i) & 1) continue;
+    if (shapes[i].x1 < lo) continue;
+    
+    float t = firstContact(shapes[i], x, y, vx, vy, ax, ay, found ? hit.t : duration);
+    if (t >= 0) {
+      found = true;
+      hit.t = t;
+      hit.x = x + vx * t + 0.5f * ax * t * t;
+      hit.y = y + vy * t + 0.5f * ay * t * t;
+      hit.index = i;
+    }
+  }
+  return found;
+}
+
+// Real roots of a·t² + b·t + c, in the cancellation-free form
+static int solveQuadratic(float a, float b, float c, float roots[2]) {
+  if (fabs(a) < 1e-12f) {
+    if (b == 0) return 0;
+    roots[0] = -c / b;
+    return 1;
+  }
+  float discriminant = b * b - 4 * a * c;
+  if (discriminant < 0) return 0;
+  float q = -0.5f * (b + (b >= 0 ? sqrt(discriminant) : -sqrt(discriminant)));
+  roots[0] = q / a;
+  roots[1] = q != 0 ? c / q : roots[0];
+  return 2;
+}
+
+// First u in [u0, u1] where the degree-4 Bernstein polynomial b reaches zero
+static float firstRoot(const float b[5], float u0, float u1, int depth) {
+  if (b[0] <= 0) return u0;
+  if (b[1] > 0 && b[2] > 0 && b[3] > 0 && b[4] > 0) return -1;
+  if (depth == 0) return u0;
+  
+  // de Casteljau split at the middle
+  float work[5] = {b[0], b[1], b[2], b[3], b[4]};
+  float left[5];
+  float right[5];
+  left[0] = work[0];
+  right[4] = work[4];
+  for (int r = 1; r < 5; r++) {
+    for (int j = 0; j < 5 - r; j++) {
+      work[j] = 0.5f * (work[j] + work[j + 1]);
+    }
+    left[r] = work[0];
+    right[4 - r] = work[4 - r];
+  }
+  
+  float mid = 0.5f * (u0 + u1);
+  float u = firstRoot(left, u0, mid, depth - 1);
+  return u >= 0 ? u : firstRoot(right, mid, u1, depth - 1);
+}
+
+float ObstacleField::firstContact(const Obstacle& o, float x, float y, float vx, float vy,
+                                  float ax, float ay, float duration) {
+  if (o.shape == SHAPE_CIRCLE) {
+    // |p(t) - c|² - r² in powers of u = t / duration
+    float r = 0.5f * (o.x1 - o.x0);
+    float dx = x - 0.5f * (o.x0 + o.x1);
+    float dy = y - 0.5f * (o.y0 + o.y1);
+    float bx = vx * duration, by = vy * duration;
+    float cx = 0.5f * ax * duration * duration, cy = 0.5f * ay * duration * duration;
+    float c0 = dx * dx + dy * dy - r * r;
+    float c1 = 2 * (dx * bx + dy * by);
+    float c2 = bx * bx + by * by + 2 * (dx * cx + dy * cy);
+    float c3 = 2 * (bx * cx + by * cy);
+    float c4 = cx * cx + cy * cy;
+    
+    float b[5] = {
+      c0,
+      c0 + c1 / 4,
+      c0 + c1 / 2 + c2 / 6,
+      c0 + c1 * 3 / 4 + c2 / 2 + c3 / 4,
+      c0 + c1 + c2 + c3 + c4
+    };
+    float u = firstRoot(b, 0, 1, ROOT_DEPTH);
+    return u >= 0 ? u * duration : -1;
+  }
+  
+  if (x >= o.x0 && x <= o.x1 && y >= o.y0 && y <= o.y1) return 0;
+  
+  // Each edge line is a quadratic in t; keep roots that land on the edge
+  float best = -1;
+  float roots[2];
+  const float edgesX[] = {o.x0, o.x1};
+  for (int e = 0; e < 2; e++) {
+    int n = solveQuadratic(0.5f * ax, vx, x - edgesX[e], roots);
+    for (int k = 0; k < n; k++) {
+      float t = roots[k];
+      if (t < 0 || t > duration || (best >= 0 && t >= best)) continue;
+      float yt = y + vy * t + 0.5f * ay * t * t;
+      if (yt >= o.y0 - EDGE_EPSILON && yt <= o.y1 + EDGE_EPSILON) best = t;
+    }
+  }
+  const float edgesY[] = {o.y0, o.y1};
+  for (int e = 0; e < 2; e++) {
+    int n = solveQuadratic(0.5f * ay, vy, y - edgesY[e], roots);
+    for (int k = 0; k < n; k++) {
+      float t = roots[k];
+      if (t < 0 || t > duration || (best >= 0 && t >= best)) continue;
+      float xt = x + vx * t + 0.5f * ax * t * t;
+      if (xt >= o.x0 - EDGE_EPSILON && xt <= o.x1 + EDGE_EPSILON) best = t;
+    }
+  }
+  return best;
+}
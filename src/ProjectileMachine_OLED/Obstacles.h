@@ -0,0 +1,83 @@
+/**
+ * Targets and obstacles with swept collision
+ *
+ * Axis-aligned rectangles and circles in world metres. Within a step
+ * the ball follows p(t) = p0 + v0·t + a·t²/2, and contact is solved on
+ * that curve rather than tested at the step's end point, so nothing is
+ * skipped however fast the ball moves. Rectangle edges are quadratics
+ * in t, solved in closed form. A circle gives a quartic, whose first
+ * root is isolated by subdividing its Bernstein form (the convex hull
+ * of the coefficients bounds the curve) down to float resolution.
+ *
+ * Shapes are sorted by their left edge, with a running maximum of the
+ * right edges, so a step only visits shapes whose x-interval overlaps
+ * the x-range it sweeps.
+ */
+
+#ifndef OBSTACLES_H
+#define OBSTACLES_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+enum ObstacleShape {
+  SHAPE_RECT,
+  SHAPE_CIRCLE
+};
+
+// Targets score and let the ball fly on; obstacles stop it
+enum ObstacleRole {
+  ROLE_TARGET,
+  ROLE_OBSTACLE
+};
+
+// Layout entry in decimetres: rectangles from their lower-left
+// corner, circles from their centre with the radius in w
+struct ObstacleDef {
+  uint8_t shape;
+  uint8_t role;
+  int16_t x, y;
+  int16_t w, h;
+};
+
+struct Obstacle {
+  uint8_t shape;
+  uint8_t role;
+  float x0, y0;  // Rectangle corners, or the circle's bounding box
+  float x1, y1;
+};
+
+struct ObstacleHit {
+  float t;  // From the start of the swept interval
+  float x;
+  float y;
+  int index;
+};
+
+class ObstacleField {
+  public:
+    void begin();
+    
+    int getCount() { return count; }
+    const Obstacle& get(int i) { return shapes[i]; }
+    bool isTarget(int i) { return shapes[i].role == ROLE_TARGET; }
+    uint32_t getTargetMask() { return targetMask; }
+    
+    // First contact along p0 + v0·t + a·t²/2 for t in [0, duration],
+    // skipping the shapes whose bit is set in skipMask
+    bool sweep(float x, float y, float vx, float vy, float ax, float ay,
+               float duration, uint32_t skipMask, ObstacleHit& hit);
+    
+  private:
+    Obstacle shapes[OBSTACLE_MAX];
+    float rightReach[OBSTACLE_MAX];  // Furthest right edge of shapes 0..i
+    int count;
+    uint32_t targetMask;
+    
+    float firstContact(const Obstacle& o, float x, float y, float vx, float vy,
+                       float ax, float ay, float duration);
+};
+
+extern ObstacleField obstacles;
+
+#endif
@@ -3,12 +3,18 @@
  */
 
 #include "Physics.h"
+#include "Terrain.h"
 #include <math.h>
 
 void PhysicsEngine::begin() {
+  forceModel = makeForceModel();
   simulationComplete = true;
+  stepCount = 0;
   trailLength = 0;
   bounceCount = 0;
+  targetMask = 0;
+  targetHits = 0;
+  stoppedBy = -1;
   maxHeight = 0;
   totalRange = 0;
   flightTime = 0;
@@ -32,6 +38,8 @@ void PhysicsEngine::startSimulation(float height, float gravity, float angle, fl
   // Initialize simulation
   currentTime = 0;
   dt = SIMULATION_DT;
+  lastStepTime = millis();
+  stepCount = 0;
   
   // Calculate initial velocities
   float vx0 = v0 * cos(this->angle);
@@ -46,81 +54,293 @@ void PhysicsEngine::startSimulation(float height, float gravity, float angle, fl
   // Initialize trail
   trailLength = 0;
   trailIndex = 0;
-  for (int i = 0; i < MAX_TRAIL_POINTS; i++) {
+  for (int i = 0; i < BUILD.trailPoints; i++) {
     trail[i] = {0, 0, 0};
   }
   
   // Reset tracking
   bounceCount = 0;
+  targetMask = 0;
+  targetHits = 0;
+  stoppedBy = -1;
   simulationComplete = false;
   maxHeight = h0;
+  priorMaxHeight = h0;
   totalRange = 0;
   flightTime = 0;
+  arc.rolling = false;
+  if (ActiveForceModel::closedForm) {
+    beginArc(0, 0, h0, vx0, vy0);
+  } else {
+    body = {0, h0, vx0, vy0};
+  }
+}
+
+int PhysicsEngine::update(unsigned long currentMillis) {
+  // Fixed steps against wall time, so a slow frame catches up instead
+  // of slowing the flight down
+  int steps = 0;
+  while (!simulationComplete && currentMillis - lastStepTime >= PHYSICS_STEP_MS) {
+    if (steps == PHYSICS_MAX_CATCHUP) {
+      // Too far behind to catch up; drop the backlog
+      lastStepTime = currentMillis;
+      break;
+    }
+    step();
+    lastStepTime += PHYSICS_STEP_MS;
+    steps++;
+  }
+  return steps;
 }
 
-void PhysicsEngine::update(unsigned long currentMillis) {
-  if (simulationComplete) return;
+int PhysicsEngine::run(int maxSteps) {
+  int steps = 0;
+  while (!simulationComplete && steps < maxSteps) {
+    step();
+    steps++;
+  }
+  return steps;
+}
+
+void PhysicsEngine::step() {
+  // Update time
+  stepCount++;
+  currentTime += dt;
   
-  static unsigned long lastUpdate = 0;
-  if (currentMillis - lastUpdate < FRAME_TIME_MS) {
-    return;
+  // Force models without a closed form are integrated until they settle
+  // into the (analytic) roll-out
+  if (!ActiveForceModel::closedForm && !arc.rolling) {
+    stepNumeric();
+  }
+  if (ActiveForceModel::closedForm || arc.rolling) {
+    stepArc();
   }
-  lastUpdate = currentMillis;
   
-  // Calculate current velocities using exact equations
-  // vx remains constant (no air resistance)
-  float vx0 = v0 * cos(angle);
-  float vy0 = v0 * sin(angle);
+  // Update trail
+  updateTrail();
+  stepHistory[stepCount % BUILD.stepHistory] = {currentPos, {vx, vy}};
+}
+
+void PhysicsEngine::stepArc() {
+  // Impacts are known in advance; a step past one starts the next arc
+  // at the exact impact time rather than at the overshooting sample.
+  // Each piece of arc the step covers is swept for targets and obstacles
+  float from = currentTime - dt;
+  while (!simulationComplete) {
+    float arcEnd = arc.startTime + arc.duration;
+    if (!arc.rolling) {
+      float t0 = max(from, arc.startTime) - arc.startTime;
+      float t1 = min(currentTime, arcEnd) - arc.startTime;
+      if (sweepObstacles(arc.startTime + t0, arc.x0 + arc.vx * t0,
+                         arc.y0 + arc.vy * t0 - 0.5f * g * t0 * t0,
+                         arc.vx, arc.vy - g * t0, 0, -g, t1 - t0)) {
+        return;
+      }
+    }
+    if (currentTime < arcEnd) break;
+    from = arcEnd;
+    endArc();
+  }
   
-  // Update time
-  currentTime += dt;
-  flightTime = currentTime;
+  float t = min(currentTime - arc.startTime, arc.duration);
   
-  // EXACT EQUATIONS - no integration errors
-  // x(t) = v₀·cos(θ)·t
-  currentPos.x = vx0 * currentTime;
+  if (arc.rolling) {
+    // Constant deceleration, following the ground
+    float decel = ROLLING_FRICTION * g;
+    currentPos.x = arc.x0 + arc.vx * t - 0.5f * decel * t * t;
+    currentPos.y = terrain.heightAt(currentPos.x);
+    vx = arc.vx - decel * t;
+    vy = 0;
+  } else {
+    // EXACT EQUATIONS - no integration errors
+    // x(t) = x₀ + vx·t
+    currentPos.x = arc.x0 + arc.vx * t;
+    
+    // y(t) = y₀ + vy·t - 0.5·g·t²
+    currentPos.y = arc.y0 + arc.vy * t - 0.5f * g * t * t;
+    
+    // Current velocities (exact)
+    vx = arc.vx;
+    vy = arc.vy - g * t;
+  }
+}
+
+void PhysicsEngine::stepNumeric() {
+  uint32_t passed = targetMask;
+  StepContact contact = stepWithContact(body, dt, g, forceModel, targetMask);
+  for (passed ^= targetMask; passed; passed &= passed - 1) {
+    targetHits++;
+  }
   
-  // y(t) = h₀ + v₀·sin(θ)·t - 0.5·g·t²
-  currentPos.y = h0 + vy0 * currentTime - 0.5f * g * currentTime * currentTime;
+  if (body.y > maxHeight) {
+    maxHeight = body.y;
+  }
   
-  // Current velocities (exact)
-  vy = vy0 - g * currentTime;
-  vx = vx0; // constant
+  float time = currentTime - dt + contact.t;
+  if (contact.kind == CONTACT_OBSTACLE) {
+    // The first obstacle ends the flight at the contact point
+    totalRange = body.x;
+    flightTime = time;
+    stoppedBy = contact.index;
+    simulationComplete = true;
+  } else if (contact.kind == CONTACT_GROUND) {
+    impact(time, body.x, body.y, body.vx, body.vy, terrain.slopeAt(body.x), contact.wall);
+  }
+  
+  currentPos.x = body.x;
+  currentPos.y = body.y;
+  vx = body.vx;
+  vy = body.vy;
+}
+
+StepContact PhysicsEngine::stepWithContact(BodyState& body, float dt, float g,
+                                           const ActiveForceModel& model, uint32_t& targetMask) {
+  BodyState prev = body;
+  advance<ActiveIntegrator>(body, dt, g, model);
+  StepContact contact = {CONTACT_NONE, dt, false, -1};
   
-  // Track maximum height
-  if (currentPos.y > maxHeight) {
-    maxHeight = currentPos.y;
+  // Ground crossing within the step, as a fraction of it
+  float clearance = body.y - terrain.heightAt(body.x);
+  float span = body.x - prev.x;
+  float f = 1;
+  if (clearance <= 0) {
+    float prevClearance = prev.y - terrain.heightAt(prev.x);
+    f = prevClearance / (prevClearance - clearance);
+    
+    // A rising cliff inside the step is hit face-on
+    float wallDistance = terrain.clearDistance(prev.x, span);
+    contact.wall = wallDistance < span;
+    if (contact.wall) f = wallDistance / span;
   }
   
-  // Update trail
-  updateTrail();
+  // Targets and obstacles up to there, along the parabola that leaves
+  // with the step's initial velocity and passes through its end point
+  float ax = 2.0f * (span - prev.vx * dt) / (dt * dt);
+  float ay = 2.0f * (body.y - prev.y - prev.vy * dt) / (dt * dt);
+  ObstacleHit hit;
+  while (obstacles.sweep(prev.x, prev.y, prev.vx, prev.vy, ax, ay, dt * f, targetMask, hit)) {
+    if (obstacles.isTarget(hit.index)) {
+      targetMask |= 1UL << hit.index;
+      continue;
+    }
+    body = {hit.x, hit.y, prev.vx + ax * hit.t, prev.vy + ay * hit.t};
+    contact = {CONTACT_OBSTACLE, hit.t, false, hit.index};
+    return contact;
+  }
   
-  // Check for ground collision (no bounce)
-  if (currentPos.y <= 0) {
-    currentPos.y = 0;
+  if (clearance <= 0) {
+    float x = prev.x + span * f;
+    float y = contact.wall ? prev.y + (body.y - prev.y) * f : terrain.heightAt(x);
+    body = {x, y, prev.vx + (body.vx - prev.vx) * f, prev.vy + (body.vy - prev.vy) * f};
+    contact.kind = CONTACT_GROUND;
+    contact.t = dt * f;
+  }
+  return contact;
+}
+
+void PhysicsEngine::beginArc(float startTime, float x0, float y0, float vx, float vy) {
+  arcHit = terrain.intersect(x0, y0, vx, vy, g);
+  arc = {startTime, arcHit.t, x0, y0, vx, vy, false};
+  
+  // Results so far are final unless another arc follows
+  totalRange = arcHit.x;
+  flightTime = startTime + arc.duration;
+  priorMaxHeight = maxHeight;
+  if (vy > 0) {
+    maxHeight = max(maxHeight, y0 + vy * vy / (2.0f * g));
+  }
+}
+
+void PhysicsEngine::endArc() {
+  if (arc.rolling) {
     simulationComplete = true;
+    return;
+  }
+  
+  impact(arc.startTime + arc.duration, arcHit.x, arcHit.y,
+         arc.vx, arc.vy - g * arc.duration, arcHit.slope, arcHit.wall);
+}
+
+bool PhysicsEngine::sweepObstacles(float startTime, float x, float y, float vx, float vy,
+                                   float ax, float ay, float duration) {
+  // Targets score once and let the ball through; the first obstacle
+  // ends the flight at the contact point
+  ObstacleHit hit;
+  while (obstacles.sweep(x, y, vx, vy, ax, ay, duration, targetMask, hit)) {
+    if (obstacles.isTarget(hit.index)) {
+      targetMask |= 1UL << hit.index;
+      targetHits++;
+      continue;
+    }
     
-    // Calculate exact range when ball hits ground
-    // Solve for t when y=0: h₀ + v₀·sin(θ)·t - 0.5·g·t² = 0
-    // Quadratic: a = -0.5*g, b = v₀·sin(θ), c = h₀
-    float a = -0.5f * g;
-    float b = vy0;
-    float c = h0;
+    currentPos = {hit.x, hit.y};
+    this->vx = vx + ax * hit.t;
+    this->vy = vy + ay * hit.t;
     
-    float discriminant = b * b - 4.0f * a * c;
-    if (discriminant >= 0) {
-      float t1 = (-b + sqrt(discriminant)) / (2.0f * a);
-      float t2 = (-b - sqrt(discriminant)) / (2.0f * a);
-      float totalTime = max(t1, t2);
-      
-      // Exact range
-      totalRange = vx0 * totalTime;
+    // Stopped on the way up: the apex was never reached
+    if (this->vy > 0) {
+      maxHeight = max(priorMaxHeight, hit.y);
+    }
+    totalRange = hit.x;
+    flightTime = startTime + hit.t;
+    stoppedBy = hit.index;
+    simulationComplete = true;
+    return true;
+  }
+  return false;
+}
+
+void PhysicsEngine::impact(float time, float x, float y, float impactVx, float impactVy,
+                           float slope, bool wall) {
+  totalRange = x;
+  flightTime = time;
+  
+  // Cliff faces stop the ball dead
+  if (wall) {
+    simulationComplete = true;
+    return;
+  }
+  
+  // Split the velocity along and across the ground, then rebuild it
+  // from the rebound components (plain vx/vy on flat ground)
+  float norm = 1.0f / sqrt(1.0f + slope * slope);
+  float along = (impactVx + impactVy * slope) * norm * HORIZONTAL_FRICTION;
+  float across = (impactVy - impactVx * slope) * norm * -COEFFICIENT_OF_RESTITUTION;
+  float reboundVx = (along - across * slope) * norm;
+  float reboundVy = (along * slope + across) * norm;
+  
+  if (bounceCount < MAX_BOUNCES && across >= BOUNCE_MIN_VELOCITY && reboundVx > 0) {
+    bounceCount++;
+    if (ActiveForceModel::closedForm) {
+      beginArc(time, x, y, reboundVx, reboundVy);
     } else {
-      totalRange = currentPos.x;
+      body = {x, y, reboundVx, reboundVy};
     }
+    return;
+  }
+  
+  float rollVx = along * norm;
+  if (ROLLING_FRICTION > 0 && rollVx > 0) {
+    // Too slow to leave the ground again; slide to a stop or a cliff
+    float decel = ROLLING_FRICTION * g;
+    float distance = rollVx * rollVx / (2.0f * decel);
+    distance = terrain.clearDistance(x, distance);
+    float duration = (rollVx - sqrt(max(rollVx * rollVx - 2.0f * decel * distance, 0.0f))) / decel;
+    arc = {time, duration, x, y, rollVx, 0, true};
+    totalRange = x + distance;
+    flightTime = time + duration;
+  } else {
+    simulationComplete = true;
   }
 }
 
+ShotSensitivity PhysicsEngine::sensitivities(float height, float gravity, float angle, float velocity) {
+  return solveOverTerrain(Sensitive::variable(height, SENS_HEIGHT),
+                          Sensitive::variable(gravity, SENS_GRAVITY),
+                          Sensitive::variable(angle, SENS_ANGLE),
+                          Sensitive::variable(velocity, SENS_VELOCITY));
+}
+
 void PhysicsEngine::calculatePrediction() {
   // Calculate trajectory points until ground impact
   predictionPoints = 0;
@@ -129,57 +349,85 @@ void PhysicsEngine::calculatePrediction() {
   float v0x = v0 * cos(angleRad);
   float v0y = v0 * sin(angleRad);
   
-  // Time to hit ground (solve quadratic)
-  float a = -0.5f * g;
-  float b = v0y;
-  float c = h0;
+  // Exact landing on the terrain
+  TerrainHit hit = terrain.intersect(0, h0, v0x, v0y, g);
+  float totalTime = hit.t;
+  Point end = {hit.x, hit.y};
+  
+  if (totalTime <= 0) return;
   
-  // Discriminant
-  float discriminant = b * b - 4 * a * c;
-  if (discriminant < 0) {
-    // No real solution (won't hit ground)
+  // Generate points
+  float step = totalTime / (BUILD.predictionPoints - 1);
+  if (!ActiveForceModel::closedForm) {
+    calculateNumericPrediction(v0x, v0y, step);
     return;
   }
   
-  float t1 = (-b + sqrt(discriminant)) / (2 * a);
-  float t2 = (-b - sqrt(discriminant)) / (2 * a);
-  float totalTime = max(t1, t2);
-  
-  if (totalTime <= 0) return;
+  // Cut short by the first obstacle; targets are flown through
+  ObstacleHit blocked;
+  if (obstacles.sweep(0, h0, v0x, v0y, 0, -g, totalTime, obstacles.getTargetMask(), blocked)) {
+    totalTime = blocked.t;
+    step = totalTime / (BUILD.predictionPoints - 1);
+    end = {blocked.x, blocked.y};
+  }
   
-  // Generate points
-  float step = totalTime / (MAX_PREDICTION_POINTS - 1);
-  for (int i = 0; i < MAX_PREDICTION_POINTS; i++) {
+  for (int i = 0; i < BUILD.predictionPoints; i++) {
     float t = i * step;
     if (t > totalTime) t = totalTime;
     
     prediction[i].x = v0x * t;
     prediction[i].y = h0 + v0y * t - 0.5f * g * t * t;
-    
-    if (prediction[i].y < 0) {
-      prediction[i].y = 0;
-      predictionPoints = i + 1;
-      break;
+    predictionPoints++;
+  }
+  prediction[predictionPoints - 1] = end;
+}
+
+void PhysicsEngine::calculateNumericPrediction(float v0x, float v0y, float step) {
+  // Integrate with the vacuum spacing; the flight length is not known
+  // up front, so a full buffer drops every other point and keeps going
+  BodyState s = {0, h0, v0x, v0y};
+  prediction[0] = {s.x, s.y};
+  predictionPoints = 1;
+  int stride = 1;
+  int sinceKept = 0;
+  
+  for (int i = 0; i < BUILD.predictionPoints * 4; i++) {
+    // Ends where the flight would: ground, cliff face or obstacle
+    uint32_t skip = obstacles.getTargetMask();
+    if (stepWithContact(s, step, g, forceModel, skip).kind != CONTACT_NONE) {
+      if (predictionPoints == BUILD.predictionPoints) predictionPoints--;
+      prediction[predictionPoints++] = {s.x, s.y};
+      return;
     }
     
-    predictionPoints++;
+    if (++sinceKept < stride) continue;
+    sinceKept = 0;
+    
+    if (predictionPoints == BUILD.predictionPoints) {
+      for (int j = 0; j < BUILD.predictionPoints / 2; j++) {
+        prediction[j] = prediction[j * 2];
+      }
+      predictionPoints = BUILD.predictionPoints / 2;
+      stride *= 2;
+    }
+    prediction[predictionPoints++] = {s.x, s.y};
   }
 }
 
 void PhysicsEngine::updateTrail() {
   // Add current position to trail
   trail[trailIndex] = {currentPos.x, currentPos.y, 0};
-  trailIndex = (trailIndex + 1) % MAX_TRAIL_POINTS;
+  trailIndex = (trailIndex + 1) % BUILD.trailPoints;
   
   // Update ages
-  for (int i = 0; i < MAX_TRAIL_POINTS; i++) {
+  for (int i = 0; i < BUILD.trailPoints; i++) {
     if (trail[i].age < 255) {
       trail[i].age += 8; // Faster aging for trail
     }
   }
   
   // Update trail length
-  trailLength = min(trailLength + 1, MAX_TRAIL_POINTS);
+  trailLength = min(trailLength + 1, BUILD.trailPoints);
 }
 
 void PhysicsEngine::stopSimulation() {
@@ -187,7 +435,7 @@ void PhysicsEngine::stopSimulation() {
   totalRange = currentPos.x;
   
   // Finalize trail
-  for (int i = 0; i < MAX_TRAIL_POINTS; i++) {
+  for (int i = 0; i < BUILD.trailPoints; i++) {
     trail[i].age = 255; // Mark as old
   }
 }
\ No newline at end of file
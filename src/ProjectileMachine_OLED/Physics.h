@@ -7,12 +7,89 @@
 
 #include <Arduino.h>
 #include "Config.h"
+#include "Dual.h"
+#include "Integrators.h"
+#include "Obstacles.h"
+#include "Profile.h"
+#include "Terrain.h"
 
 struct Point {
   float x;
   float y;
 };
 
+template <typename T>
+struct ShotResultOf {
+  T range;
+  T maxHeight;
+  T flightTime;
+};
+
+typedef ShotResultOf<float> ShotResult;
+
+// Inputs the results are differentiated against
+enum SensitivityInput {
+  SENS_ANGLE,     // Per degree
+  SENS_VELOCITY,  // Per m/s
+  SENS_HEIGHT,    // Per m
+  SENS_GRAVITY,   // Per m/s²
+  SENS_INPUTS
+};
+
+typedef Dual<SENS_INPUTS> Sensitive;
+typedef ShotResultOf<Sensitive> ShotSensitivity;
+
+// One ballistic arc (or the final roll along the ground) of a flight
+struct Arc {
+  float startTime;
+  float duration;
+  float x0, y0;
+  float vx, vy;
+  bool rolling;  // Sliding along the ground, decelerating
+};
+
+// Launches for solveBatch, one array per setting (angle in degrees)
+struct ShotBatch {
+  const float* height;
+  const float* gravity;
+  const float* angle;
+  const float* velocity;
+  int count;
+};
+
+// Results of solveBatch, one array per quantity. Positions on each arc
+// at a shared time grid are optional: sample s of shot i lands in
+// x[s * count + i] and y[s * count + i]
+struct ShotBatchResults {
+  float* range;
+  float* maxHeight;
+  float* flightTime;
+  const float* times;  // NULL for no samples
+  int samples;
+  float* x;
+  float* y;
+};
+
+// Where a fixed step left the ball
+struct StepRecord {
+  Point position;
+  Point velocity;
+};
+
+// What an integrated step ran into first, if anything
+enum ContactKind {
+  CONTACT_NONE,
+  CONTACT_GROUND,
+  CONTACT_OBSTACLE
+};
+
+struct StepContact {
+  ContactKind kind;
+  float t;     // Into the step; the whole step when nothing was hit
+  bool wall;   // Ground contact on a rising cliff face
+  int index;   // The obstacle, for CONTACT_OBSTACLE
+};
+
 struct TrailPoint {
   float x;
   float y;
@@ -27,14 +104,20 @@ class PhysicsEngine {
     void setParameters(float height, float gravity, float angle, float velocity);
     void startSimulation(float height, float gravity, float angle, float velocity);
     
-    // Simulation
-    void update(unsigned long currentTime);
+    // Simulation; returns the number of fixed steps taken
+    int update(unsigned long currentTime);
     bool isSimulationComplete() { return simulationComplete; }
+    unsigned long getNextStepTime() { return lastStepTime + PHYSICS_STEP_MS; }
+    
+    // Up to maxSteps fixed steps with no wall-clock pacing, for analyses
+    // that fly shots off screen; returns the number taken
+    int run(int maxSteps);
     
     // Getters
     Point getCurrentPosition() { return currentPos; }
     Point getCurrentVelocity() { return {vx, vy}; }
     TrailPoint* getTrail() { return trail; }
+    const StepRecord* getStepHistory() { return stepHistory; }
     int getTrailLength() { return trailLength; }
     Point* getPrediction() { return prediction; }
     int getPredictionPoints() { return predictionPoints; }
@@ -42,9 +125,53 @@ class PhysicsEngine {
     float getMaxHeight() { return maxHeight; }
     float getTotalRange() { return totalRange; }
     float getFlightTime() { return flightTime; }
+    int getBounceCount() { return bounceCount; }
+    
+    // Targets passed through (one bit per obstacle index), and the
+    // obstacle that ended the flight, or -1
+    int getTargetHits() { return targetHits; }
+    uint32_t getTargetMask() { return targetMask; }
+    int getStoppedBy() { return stoppedBy; }
+    
+    // Closed-form results to the first impact over flat ground (angle in
+    // degrees), for float or a dual number carrying derivatives
+    template <typename T>
+    static ShotResultOf<T> solve(T height, T gravity, T angle, T velocity);
+    
+    // The same from the launch velocity components
+    template <typename T>
+    static ShotResultOf<T> solveLaunch(T height, T gravity, T vx, T vy);
+    
+    // The same to the first impact on the terrain
+    template <typename T>
+    static ShotResultOf<T> solveOverTerrain(T height, T gravity, T angle, T velocity);
+    
+    // Results over the terrain with their partial derivatives with
+    // respect to each launch setting, in one evaluation
+    static ShotSensitivity sensitivities(float height, float gravity, float angle, float velocity);
+    
+    // solve() and arcPosition() over many launches at once, on SIMD
+    // lanes where the host has them, bit for bit as shot by shot
+    static void solveBatch(const ShotBatch& shots, ShotBatchResults& out);
+    static const char* batchKernel();  // "avx2", "neon" or "scalar"
+    
+    // Launch velocity components, as solve() takes them
+    template <typename T>
+    static void launchVelocity(T angle, T velocity, T& vx, T& vy);
+    
+    // Position on the flat-ground arc at time t, held at the impact
+    static Point arcPosition(float height, float gravity, float vx, float vy, float flightTime, float t);
+    
+    // One integrated step of body, cut short at its first contact: the
+    // ground or a cliff face inside the step, or an obstacle swept along
+    // the step's parabola. Targets missing from targetMask are flown
+    // through and added to it. Salvos and the sweep step the same way
+    static StepContact stepWithContact(BodyState& body, float dt, float g,
+                                       const ActiveForceModel& model, uint32_t& targetMask);
     
     // For dotted path
     float getCurrentTime() { return currentTime; }
+    uint32_t getStepCount() { return stepCount; }
     
   private:
     // Simulation state
@@ -55,32 +182,127 @@ class PhysicsEngine {
     float vx0, vy0; // Initial velocities
     float currentTime;
     float dt;
+    unsigned long lastStepTime;
+    uint32_t stepCount;
     
     float vx, vy; // Current velocities
     Point currentPos;
     
     // Trail
-    TrailPoint trail[MAX_TRAIL_POINTS];
+    TrailPoint trail[BUILD.trailPoints];
     int trailLength;
     int trailIndex;
     
+    // The last steps, each at its step number modulo the length
+    StepRecord stepHistory[BUILD.stepHistory];
+    
+    // Force model; body is the integrated state when it has no closed form
+    ActiveForceModel forceModel;
+    BodyState body;
+    
     // Bounce tracking
+    Arc arc; // Arc in progress
+    TerrainHit arcHit; // Where it comes down
     int bounceCount;
     bool simulationComplete;
     
+    // Targets and obstacles
+    uint32_t targetMask;
+    int targetHits;
+    int stoppedBy;
+    float priorMaxHeight; // Before the arc in progress raised it to its apex
+    
     // Results
     float maxHeight;
     float totalRange;
     float flightTime;
     
     // Prediction
-    Point prediction[MAX_PREDICTION_POINTS];
+    Point prediction[BUILD.predictionPoints];
     int predictionPoints;
     
     // Helper methods
     void calculatePrediction();
+    void calculateNumericPrediction(float v0x, float v0y, float step);
+    void step();
+    void stepArc();
+    void stepNumeric();
+    void impact(float time, float x, float y, float impactVx, float impactVy, float slope, bool wall);
+    void beginArc(float startTime, float x0, float y0, float vx, float vy);
+    void endArc();
+    bool sweepObstacles(float startTime, float x, float y, float vx, float vy,
+                        float ax, float ay, float duration);
+    template <typename T>
+    static T impactTime(T y0, T vy, T gravity);
     void updateTrail();
     void stopSimulation();
 };
 
+template <typename T>
+T PhysicsEngine::impactTime(T y0, T vy, T gravity) {
+  // Positive root of y₀ + vy·t - 0.5·g·t² = 0
+  T discriminant = vy * vy + 2.0f * gravity * y0;
+  return discriminant >= 0 ? (vy + sqrt(discriminant)) / gravity : T(0);
+}
+
+template <typename T>
+void PhysicsEngine::launchVelocity(T angle, T velocity, T& vx, T& vy) {
+  T angleRad = angle * M_PI / 180.0f;
+  vx = velocity * cos(angleRad);
+  vy = velocity * sin(angleRad);
+}
+
+inline Point PhysicsEngine::arcPosition(float height, float gravity, float vx, float vy,
+                                        float flightTime, float t) {
+  float s = min(t, flightTime);
+  Point p;
+  p.x = vx * s;
+  p.y = height + vy * s - 0.5f * gravity * s * s;
+  return p;
+}
+
+template <typename T>
+ShotResultOf<T> PhysicsEngine::solve(T height, T gravity, T angle, T velocity) {
+  T vx0, vy0;
+  launchVelocity(angle, velocity, vx0, vy0);
+  return solveLaunch(height, gravity, vx0, vy0);
+}
+
+template <typename T>
+ShotResultOf<T> PhysicsEngine::solveLaunch(T height, T gravity, T vx0, T vy0) {
+  ShotResultOf<T> result;
+  
+  // Apex is above the launch point only when fired upward
+  result.maxHeight = vy0 > 0 ? height + vy0 * vy0 / (2.0f * gravity) : height;
+  
+  result.flightTime = impactTime(height, vy0, gravity);
+  result.range = vx0 * result.flightTime;
+  
+  return result;
+}
+
+template <typename T>
+ShotResultOf<T> PhysicsEngine::solveOverTerrain(T height, T gravity, T angle, T velocity) {
+  T vx0, vy0;
+  launchVelocity(angle, velocity, vx0, vy0);
+  ShotResultOf<T> result = solveLaunch(height, gravity, vx0, vy0);
+  
+  // The landing is searched on the values alone. One Newton step on the
+  // landing condition, taken from the exact root, leaves the time as it
+  // is and gives its derivatives (the implicit function theorem)
+  TerrainHit hit = terrain.intersect(0, valueOf(height), valueOf(vx0), valueOf(vy0), valueOf(gravity));
+  T t = hit.t;
+  T x = vx0 * t;
+  T y = height + vy0 * t - 0.5f * gravity * t * t;
+  
+  // Cliff faces are vertical lines, anything else the segment's slope
+  T miss = hit.wall ? x - hit.x : y - hit.y - hit.slope * (x - hit.x);
+  T rate = hit.wall ? vx0 : vy0 - gravity * t - hit.slope * vx0;
+  if (valueOf(rate) != 0) t = t - miss / rate;
+  
+  result.flightTime = t;
+  result.range = vx0 * t;
+  return result;
+}
+
 #endif
\ No newline at end of file
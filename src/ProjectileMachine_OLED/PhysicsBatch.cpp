@@ -0,0 +1,157 @@
+/**
+ * Batch solver
+ *
+ * solve() over structure-of-arrays launches. Every lane performs the
+ * same IEEE operations in the same order as the scalar code, so the
+ * results match it bit for bit. The degree conversion and the trig stay
+ * per shot, through launchVelocity() as solve() does. Everything after
+ * the launch velocity runs on 8 lanes with AVX2 (chosen at run time) or
+ * 4 with NEON: the apex, the impact root, the range and the positions
+ * on the time grid. Shots left over, and every shot on other targets,
+ * take the scalar path.
+ *
+ * A fused multiply-add rounds once where the scalar code rounds twice,
+ * so nothing here may be contracted. GCC does not fuse on x86 without
+ * -mfma; on AArch64 build with -ffp-contract=off.
+ */
+
+#include "Physics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+static void solveShot(const ShotBatch& shots, ShotBatchResults& out, int i) {
+  float h = shots.height[i];
+  float g = shots.gravity[i];
+  float vx, vy;
+  PhysicsEngine::launchVelocity(shots.angle[i], shots.velocity[i], vx, vy);
+  ShotResult r = PhysicsEngine::solveLaunch(h, g, vx, vy);
+  out.range[i] = r.range;
+  out.maxHeight[i] = r.maxHeight;
+  out.flightTime[i] = r.flightTime;
+  
+  for (int s = 0; s < out.samples; s++) {
+    Point p = PhysicsEngine::arcPosition(h, g, vx, vy, r.flightTime, out.times[s]);
+    out.x[s * shots.count + i] = p.x;
+    out.y[s * shots.count + i] = p.y;
+  }
+}
+
+#if BATCH_AVX2
+// Returns the number of shots solved, a multiple of 8
+__attribute__((target("avx2")))
+static int solveAvx2(const ShotBatch& shots, ShotBatchResults& out) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 two = _mm256_set1_ps(2.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  int n = shots.count & ~7;
+  
+  for (int i = 0; i < n; i += 8) {
+    float vxLanes[8], vyLanes[8];
+    for (int k = 0; k < 8; k++) {
+      PhysicsEngine::launchVelocity(shots.angle[i + k], shots.velocity[i + k], vxLanes[k], vyLanes[k]);
+    }
+    __m256 vx = _mm256_loadu_ps(vxLanes);
+    __m256 vy = _mm256_loadu_ps(vyLanes);
+    __m256 h = _mm256_loadu_ps(shots.height + i);
+    __m256 g = _mm256_loadu_ps(shots.gravity + i);
+    
+    // vy > 0 ? h + vy² / (2g) : h
+    __m256 twoG = _mm256_mul_ps(two, g);
+    __m256 vy2 = _mm256_mul_ps(vy, vy);
+    __m256 apex = _mm256_add_ps(h, _mm256_div_ps(vy2, twoG));
+    __m256 maxHeight = _mm256_blendv_ps(h, apex, _mm256_cmp_ps(vy, zero, _CMP_GT_OQ));
+    
+    // d >= 0 ? (vy + √d) / g : 0, with d = vy² + 2g·h
+    __m256 d = _mm256_add_ps(vy2, _mm256_mul_ps(twoG, h));
+    __m256 root = _mm256_div_ps(_mm256_add_ps(vy, _mm256_sqrt_ps(d)), g);
+    __m256 t = _mm256_blendv_ps(zero, root, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+    
+    _mm256_storeu_ps(out.range + i, _mm256_mul_ps(vx, t));
+    _mm256_storeu_ps(out.maxHeight + i, maxHeight);
+    _mm256_storeu_ps(out.flightTime + i, t);
+    
+    __m256 halfG = _mm256_mul_ps(half, g);
+    for (int s = 0; s < out.samples; s++) {
+      // min(time, t) picks t only when t < time, as min() does
+      __m256 at = _mm256_min_ps(t, _mm256_set1_ps(out.times[s]));
+      __m256 y = _mm256_sub_ps(_mm256_add_ps(h, _mm256_mul_ps(vy, at)),
+                               _mm256_mul_ps(_mm256_mul_ps(halfG, at), at));
+      _mm256_storeu_ps(out.x + s * shots.count + i, _mm256_mul_ps(vx, at));
+      _mm256_storeu_ps(out.y + s * shots.count + i, y);
+    }
+  }
+  return n;
+}
+#endif
+
+#if BATCH_NEON
+// Returns the number of shots solved, a multiple of 4
+static int solveNeon(const ShotBatch& shots, ShotBatchResults& out) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t two = vdupq_n_f32(2.0f);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  int n = shots.count & ~3;
+  
+  for (int i = 0; i < n; i += 4) {
+    float vxLanes[4], vyLanes[4];
+    for (int k = 0; k < 4; k++) {
+      PhysicsEngine::launchVelocity(shots.angle[i + k], shots.velocity[i + k], vxLanes[k], vyLanes[k]);
+    }
+    float32x4_t vx = vld1q_f32(vxLanes);
+    float32x4_t vy = vld1q_f32(vyLanes);
+    float32x4_t h = vld1q_f32(shots.height + i);
+    float32x4_t g = vld1q_f32(shots.gravity + i);
+    
+    float32x4_t twoG = vmulq_f32(two, g);
+    float32x4_t vy2 = vmulq_f32(vy, vy);
+    float32x4_t apex = vaddq_f32(h, vdivq_f32(vy2, twoG));
+    float32x4_t maxHeight = vbslq_f32(vcgtq_f32(vy, zero), apex, h);
+    
+    float32x4_t d = vaddq_f32(vy2, vmulq_f32(twoG, h));
+    float32x4_t root = vdivq_f32(vaddq_f32(vy, vsqrtq_f32(d)), g);
+    float32x4_t t = vbslq_f32(vcgeq_f32(d, zero), root, zero);
+    
+    vst1q_f32(out.range + i, vmulq_f32(vx, t));
+    vst1q_f32(out.maxHeight + i, maxHeight);
+    vst1q_f32(out.flightTime + i, t);
+    
+    float32x4_t halfG = vmulq_f32(half, g);
+    for (int s = 0; s < out.samples; s++) {
+      // A compare and select, since vminq_f32 treats NaN unlike min()
+      float32x4_t time = vdupq_n_f32(out.times[s]);
+      float32x4_t at = vbslq_f32(vcltq_f32(t, time), t, time);
+      float32x4_t y = vsubq_f32(vaddq_f32(h, vmulq_f32(vy, at)), vmulq_f32(vmulq_f32(halfG, at), at));
+      vst1q_f32(out.x + s * shots.count + i, vmulq_f32(vx, at));
+      vst1q_f32(out.y + s * shots.count + i, y);
+    }
+  }
+  return n;
+}
+#endif
+
+void PhysicsEngine::solveBatch(const ShotBatch& shots, ShotBatchResults& out) {
+  int done = 0;
+#if BATCH_AVX2
+  if (__builtin_cpu_supports("avx2")) done = solveAvx2(shots, out);
+#elif BATCH_NEON
+  done = solveNeon(shots, out);
+#endif
+  for (int i = done; i < shots.count; i++) {
+    solveShot(shots, out, i);
+  }
+}
+
+const char* PhysicsEngine::batchKernel() {
+#if BATCH_AVX2
+  if (__builtin_cpu_supports("avx2")) return "avx2";
+#elif BATCH_NEON
+  return "neon";
+#endif
+  return "scalar";
+}
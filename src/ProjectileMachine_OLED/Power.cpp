@@ -0,0 +1,192 @@
+/**
+ * Power management implementation
+ */
+
+#include "Power.h"
+#include "Pins.h"
+#if defined(ESP8266)
+#include <ESP8266WiFi.h>
+extern "C" {
+#include <user_interface.h>
+#include <gpio.h>
+}
+#endif
+
+// Set from the button edge interrupts, cleared by update()
+static volatile bool buttonEdge = false;
+
+static void IRAM_ATTR onButtonEdge() {
+  buttonEdge = true;
+}
+
+PowerManager::PowerManager(Adafruit_SSD1306* disp) {
+  display = disp;
+  panelMode = PANEL_ON;
+  lastActivity = 0;
+  swallowing = false;
+  lastIdleEnd = 0;
+  uncountedMicros = 0;
+}
+
+void PowerManager::begin() {
+#if defined(ESP8266)
+  // The firmware never uses Wi-Fi; keep the modem powered down
+  WiFi.mode(WIFI_OFF);
+  WiFi.forceSleepBegin();
+  delay(1);
+#endif
+  
+  attachInterrupt(digitalPinToInterrupt(BUTTON_UP), onButtonEdge, FALLING);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_DOWN), onButtonEdge, FALLING);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_ENTER), onButtonEdge, FALLING);
+  
+  for (int i = 0; i < POWER_MAX_STATES; i++) {
+    stats[i] = {0, 0, 0};
+  }
+  lastActivity = millis();
+  lastIdleEnd = micros();
+  uncountedMicros = 0;
+  setPanel(PANEL_ON);
+}
+
+bool PowerManager::update(unsigned long now, bool buttonDown, bool hadInput) {
+  if (buttonEdge) {
+    buttonEdge = false;
+    buttonDown = true;
+  }
+  
+  if (buttonDown || hadInput) {
+    // The press that turns a blank panel back on does nothing else
+    if (panelMode == PANEL_OFF) {
+      swallowing = true;
+    }
+    lastActivity = now;
+    setPanel(PANEL_ON);
+  } else if (panelMode == PANEL_ON && now - lastActivity >= POWER_DIM_MS) {
+    setPanel(PANEL_DIM);
+  } else if (panelMode == PANEL_DIM && now - lastActivity >= POWER_BLANK_MS) {
+    setPanel(PANEL_OFF);
+  }
+  
+  bool swallow = swallowing;
+  if (!buttonDown) {
+    swallowing = false;
+  }
+  return swallow;
+}
+
+unsigned long PowerManager::getFramePeriod(bool staticState, unsigned long activePeriod) {
+  if (staticState && millis() - lastActivity >= POWER_ACTIVE_HOLD_MS) {
+    return max(activePeriod, (unsigned long)POWER_STATIC_FRAME_MS);
+  }
+  return activePeriod;
+}
+
+void PowerManager::idle(uint8_t state, bool allowed, unsigned long nextFrameTime) {
+  if (state >= POWER_MAX_STATES) state = POWER_MAX_STATES - 1;
+  
+  unsigned long start = micros();
+  stats[state].activeMicros += start - lastIdleEnd;
+  
+  unsigned long now = millis();
+  if (allowed && now - lastActivity >= POWER_ACTIVE_HOLD_MS) {
+    // Wake for the next frame, or in time for the next button poll
+    long wait = (long)(nextFrameTime - now);
+    if (wait > POWER_POLL_MS) wait = POWER_POLL_MS;
+    
+    if (wait >= POWER_MIN_WAIT_MS) {
+      if (POWER_LIGHT_SLEEP && panelMode != PANEL_ON) {
+        unsigned long slept = lightSleep(wait);
+        stats[state].sleepMicros += slept;
+        
+        // millis() stood still for part of the sleep; age the inactivity
+        // timer by the time it missed so dim and blank still come on time
+        unsigned long counted = micros() - start;
+        if (slept > counted) {
+          uncountedMicros += slept - counted;
+          lastActivity -= uncountedMicros / 1000;
+          uncountedMicros %= 1000;
+        }
+      } else {
+        delay(wait);
+        stats[state].waitMicros += micros() - start;
+      }
+    }
+  }
+  
+  lastIdleEnd = micros();
+}
+
+void PowerManager::setPanel(PanelMode mode) {
+  if (mode == panelMode) return;
+  
+  if (panelMode == PANEL_OFF) {
+    display->ssd1306_command(SSD1306_DISPLAYON);
+  }
+  
+  switch (mode) {
+    case PANEL_ON:
+      display->dim(false);
+      break;
+    case PANEL_DIM:
+      display->dim(true);
+      break;
+    case PANEL_OFF:
+      display->ssd1306_command(SSD1306_DISPLAYOFF);
+      break;
+  }
+  panelMode = mode;
+}
+
+unsigned long PowerManager::lightSleep(unsigned long ms) {
+#if defined(ESP8266)
+  // The CPU clock stops in forced light sleep, so the time asleep comes
+  // from the RTC, whose period the SDK gives in µs as Q12 fixed point
+  uint32_t rtcStart = system_get_rtc_time();
+  
+  // Forced light sleep with a timer and all three buttons as wake sources
+  wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+  wifi_fpm_open();
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(BUTTON_UP), GPIO_PIN_INTR_LOLEVEL);
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(BUTTON_DOWN), GPIO_PIN_INTR_LOLEVEL);
+  gpio_pin_wakeup_enable(GPIO_ID_PIN(BUTTON_ENTER), GPIO_PIN_INTR_LOLEVEL);
+  wifi_fpm_do_sleep(ms * 1000);
+  delay(ms + 1); // Sleep starts once the SDK gets control
+  gpio_pin_wakeup_disable();
+  wifi_fpm_close();
+  
+  uint32_t rtcCycles = system_get_rtc_time() - rtcStart;
+  return ((uint64_t)rtcCycles * system_rtc_clock_cali_proc()) >> 12;
+#else
+  unsigned long start = micros();
+  delay(ms);
+  return micros() - start;
+#endif
+}
+
+void PowerManager::dump(Print& out) {
+  out.println(F("state total_ms active% wait% sleep% est_mA"));
+  
+  for (int i = 0; i < POWER_MAX_STATES; i++) {
+    StateStats& s = stats[i];
+    uint64_t total = s.activeMicros + s.waitMicros + s.sleepMicros;
+    if (total == 0) continue;
+    
+    float active = (float)s.activeMicros / total;
+    float wait = (float)s.waitMicros / total;
+    float sleep = (float)s.sleepMicros / total;
+    float current = active * POWER_ACTIVE_MA + wait * POWER_WAIT_MA + sleep * POWER_SLEEP_MA;
+    
+    out.print(i);
+    out.print(' ');
+    out.print((unsigned long)(total / 1000));
+    out.print(' ');
+    out.print(active * 100, 1);
+    out.print(' ');
+    out.print(wait * 100, 1);
+    out.print(' ');
+    out.print(sleep * 100, 1);
+    out.print(' ');
+    out.println(current, 1);
+  }
+}
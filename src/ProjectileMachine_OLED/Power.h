@@ -0,0 +1,65 @@
+/**
+ * Power management for battery-powered units
+ *
+ * The Wi-Fi radio is shut down at boot. Static screens redraw at a
+ * reduced rate and the loop waits between button polls instead of
+ * spinning; once the panel has been dimmed for inactivity, those waits
+ * become forced light sleep woken by the button GPIOs. Time spent
+ * active, waiting and sleeping is tracked per state.
+ *
+ * Serial input cannot wake the chip from light sleep, so console
+ * commands are only read while the panel is at full brightness.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "Config.h"
+
+enum PanelMode {
+  PANEL_ON,
+  PANEL_DIM,
+  PANEL_OFF
+};
+
+class PowerManager {
+  public:
+    PowerManager(Adafruit_SSD1306* disp);
+    void begin();
+    
+    // Feed input each pass; returns true when the input only woke the
+    // panel and should be ignored by the state handlers
+    bool update(unsigned long now, bool buttonDown, bool hadInput);
+    
+    // Redraw period for the current state
+    unsigned long getFramePeriod(bool staticState, unsigned long activePeriod);
+    bool isBlanked() { return panelMode == PANEL_OFF; }
+    
+    // Wait until the next frame or button poll is due; call at the end of loop()
+    void idle(uint8_t state, bool allowed, unsigned long nextFrameTime);
+    
+    void dump(Print& out);
+    
+  private:
+    Adafruit_SSD1306* display;
+    PanelMode panelMode;
+    unsigned long lastActivity;
+    bool swallowing;
+    
+    // Per-state time accounting
+    struct StateStats {
+      uint64_t activeMicros;
+      uint64_t waitMicros;
+      uint64_t sleepMicros;
+    };
+    StateStats stats[POWER_MAX_STATES];
+    unsigned long lastIdleEnd;
+    unsigned long uncountedMicros;  // Slept while micros() was stopped, under 1 ms
+    
+    void setPanel(PanelMode mode);
+    unsigned long lightSleep(unsigned long ms);  // Returns µs actually asleep
+};
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * Build profiles
+ *
+ * Path buffer sizes, the ghost count and the frame period come as one
+ * typed set, chosen with BUILD_PROFILE in Config.h (or
+ * -DBUILD_PROFILE=...). The engine and renderer size their buffers and
+ * bound their loops from BUILD. The step history has to cover one
+ * update()'s catch-up (PHYSICS_MAX_CATCHUP); a longer one gives a
+ * Ticker-driven engine slack when the loop falls behind.
+ * Every profile declares a RAM and a frame budget, and its cost is
+ * estimated at compile time (see the end of UI.h), so a profile that
+ * does not fit fails the build rather than the device.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "Config.h"
+
+struct BuildProfile {
+  const char* name;
+  int predictionPoints;  // Predicted path samples
+  int trailPoints;       // Trail behind the ball
+  int dottedPoints;      // Flown path markers
+  int ghostShots;        // Previous shots redrawn as ghost arcs
+  int stepHistory;       // Recent steps a flight snapshot carries
+  int frameTimeMs;       // Full-rate frame period
+  uint32_t ramBudget;    // Bytes for the path buffers
+};
+
+// Indexed by the BUILD_* values in Config.h
+constexpr BuildProfile PROFILES[] = {
+  {"balanced", 60, 8, 60, 8, 4, 33, 2048},
+  {"low-ram", 30, 4, 30, 4, 4, 33, 1152},
+  {"high-fps", 40, 8, 40, 8, 8, 28, 2048},
+  {"precision", 120, 16, 120, 8, 8, 40, 4096}
+};
+
+constexpr int PROFILE_COUNT = sizeof(PROFILES) / sizeof(PROFILES[0]);
+static_assert(BUILD_PROFILE >= 0 && BUILD_PROFILE < PROFILE_COUNT, "Unknown BUILD_PROFILE");
+
+constexpr BuildProfile BUILD = PROFILES[BUILD_PROFILE];
+
+// Rough per-frame costs on the ESP8266 at 80 MHz. The perf overlay's
+// render and flush stages give the real figures to refine these
+constexpr uint32_t COST_FLUSH_US = 24000;      // 1 KB over I2C at 400 kHz
+constexpr uint32_t COST_SCREEN_US = 1500;      // Terrain, cannon and text
+constexpr uint32_t COST_PREDICTION_US = 30;    // Per predicted point drawn
+constexpr uint32_t COST_DOT_US = 8;            // Per flown path marker
+constexpr uint32_t COST_TRAIL_US = 12;         // Per trail point
+constexpr uint32_t COST_GHOST_US = 80;         // Per ghost arc, integer stepped
+
+// Every buffer drawn in one frame, as if on one screen
+constexpr uint32_t profileFrameCostUs(const BuildProfile& p) {
+  return COST_FLUSH_US + COST_SCREEN_US + p.predictionPoints * COST_PREDICTION_US +
+         p.dottedPoints * COST_DOT_US + p.trailPoints * COST_TRAIL_US + p.ghostShots * COST_GHOST_US;
+}
+
+#endif
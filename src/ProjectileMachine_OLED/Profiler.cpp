@@ -0,0 +1,145 @@
+/**
+ * Stage profiler implementation
+ */
+
+#include "Profiler.h"
+
+Profiler profiler;
+
+// Histogram bucket i holds samples below (32us << i); the last one is open
+static const uint32_t HIST_BASE_US = 32;
+
+void Profiler::begin() {
+#if defined(ESP8266)
+  cyclesPerMicro = ESP.getCpuFreqMHz();
+#else
+  cyclesPerMicro = 1000; // Host counter runs in nanoseconds
+#endif
+  overlayEnabled = false;
+  reset();
+}
+
+void Profiler::reset() {
+  for (int i = 0; i < PROFILER_STAGES; i++) {
+    stats[i].minCycles = 0xFFFFFFFF;
+    stats[i].maxCycles = 0;
+    stats[i].count = 0;
+    stats[i].totalCycles = 0;
+    for (int b = 0; b < PROFILER_HIST_BUCKETS; b++) {
+      stats[i].histogram[b] = 0;
+    }
+  }
+  fpsWindowStart = millis();
+  fpsFrames = 0;
+  fps = 0;
+}
+
+void Profiler::record(uint8_t stage, uint32_t elapsedCycles) {
+  if (stage >= PROFILER_STAGES) return;
+  StageStats& s = stats[stage];
+  
+  if (elapsedCycles < s.minCycles) s.minCycles = elapsedCycles;
+  if (elapsedCycles > s.maxCycles) s.maxCycles = elapsedCycles;
+  s.count++;
+  s.totalCycles += elapsedCycles;
+  
+  // Log2 bucket of the duration in microseconds
+  uint32_t us = toMicros(elapsedCycles);
+  uint8_t bucket = 0;
+  uint32_t limit = HIST_BASE_US;
+  while (bucket < PROFILER_HIST_BUCKETS - 1 && us >= limit) {
+    bucket++;
+    limit <<= 1;
+  }
+  if (s.histogram[bucket] < 0xFFFF) {
+    s.histogram[bucket]++;
+  }
+}
+
+void Profiler::frameRendered(uint32_t frameCycles) {
+  record(STAGE_FRAME, frameCycles);
+  
+  fpsFrames++;
+  unsigned long now = millis();
+  if (now - fpsWindowStart >= 1000) {
+    fps = fpsFrames;
+    fpsFrames = 0;
+    fpsWindowStart = now;
+  }
+}
+
+float Profiler::getAverageMs(uint8_t stage) {
+  if (stage >= PROFILER_STAGES) return 0;
+  return (float)averageCycles(stage) / cyclesPerMicro / 1000.0f;
+}
+
+float Profiler::getFrameMs() {
+  return getAverageMs(STAGE_FRAME);
+}
+
+uint8_t Profiler::getTopStages(uint8_t* out, uint8_t maxCount) {
+  // Insertion sort by average cost, skipping the frame total itself
+  uint8_t found = 0;
+  for (uint8_t i = 0; i < PROFILER_STAGES; i++) {
+    if (i == STAGE_FRAME || stats[i].count == 0) continue;
+    
+    uint32_t avg = averageCycles(i);
+    if (found < maxCount) {
+      found++;
+    } else if (avg <= averageCycles(out[found - 1])) {
+      continue;
+    }
+    
+    uint8_t pos = found - 1;
+    while (pos > 0 && avg > averageCycles(out[pos - 1])) {
+      out[pos] = out[pos - 1];
+      pos--;
+    }
+    out[pos] = i;
+  }
+  return found;
+}
+
+void Profiler::getStageName(uint8_t stage, char* buf) {
+  switch (stage) {
+    case STAGE_BUTTONS: strcpy(buf, "btn"); return;
+    case STAGE_PHYSICS: strcpy(buf, "phys"); return;
+    case STAGE_FLUSH: strcpy(buf, "flush"); return;
+    case STAGE_FRAME: strcpy(buf, "frame"); return;
+  }
+  
+  // Per-state stages: h<state> for handlers, r<state> for renders
+  uint8_t offset = stage - STAGE_FIXED_COUNT;
+  buf[0] = (offset & 1) ? 'r' : 'h';
+  itoa(offset / 2, buf + 1, 10);
+}
+
+void Profiler::dump(Print& out) {
+  out.println(F("stage count min_us avg_us max_us | hist <32us x2 ..."));
+  
+  char name[8];
+  for (uint8_t i = 0; i < PROFILER_STAGES; i++) {
+    StageStats& s = stats[i];
+    if (s.count == 0) continue;
+    
+    getStageName(i, name);
+    out.print(name);
+    out.print(' ');
+    out.print(s.count);
+    out.print(' ');
+    out.print(toMicros(s.minCycles));
+    out.print(' ');
+    out.print(toMicros(averageCycles(i)));
+    out.print(' ');
+    out.print(toMicros(s.maxCycles));
+    out.print(F(" |"));
+    for (int b = 0; b < PROFILER_HIST_BUCKETS; b++) {
+      out.print(' ');
+      out.print(s.histogram[b]);
+    }
+    out.println();
+  }
+  
+  out.print(F("fps "));
+  out.println(fps);
+}
@@ -0,0 +1,112 @@
+/**
+ * Cycle-accurate stage profiler for the main loop
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+#if !defined(ESP8266)
+#include <chrono>
+#endif
+
+// Fixed stages; each app state also gets a handler and a render stage
+enum ProfileStage {
+  STAGE_BUTTONS,
+  STAGE_PHYSICS,
+  STAGE_FLUSH,
+  STAGE_FRAME,     // Whole loop() pass that rendered a frame
+  STAGE_FIXED_COUNT
+};
+
+#define PROFILE_HANDLER_STAGE(state) (STAGE_FIXED_COUNT + (state) * 2)
+#define PROFILE_RENDER_STAGE(state) (STAGE_FIXED_COUNT + (state) * 2 + 1)
+#define PROFILER_STAGES (STAGE_FIXED_COUNT + PROFILER_MAX_STATES * 2)
+
+class Profiler {
+  public:
+    void begin();
+    void reset();
+    
+    // Raw cycle counter (ESP cycles on target, nanoseconds on the host)
+    static uint32_t cycles() {
+#if defined(ESP8266)
+      return ESP.getCycleCount();
+#else
+      return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    
+    void record(uint8_t stage, uint32_t elapsedCycles);
+    void frameRendered(uint32_t frameCycles);
+    
+    // Overlay
+    void toggleOverlay() { overlayEnabled = !overlayEnabled; }
+    bool isOverlayEnabled() { return overlayEnabled; }
+    
+    // Summary for the overlay
+    uint8_t getFps() { return fps; }
+    float getFrameMs();
+    uint8_t getTopStages(uint8_t* out, uint8_t maxCount);
+    float getAverageMs(uint8_t stage);
+    void getStageName(uint8_t stage, char* buf);
+    
+    // Full table over Serial
+    void dump(Print& out);
+    
+  private:
+    struct StageStats {
+      uint32_t minCycles;
+      uint32_t maxCycles;
+      uint32_t count;
+      uint64_t totalCycles;
+      uint16_t histogram[PROFILER_HIST_BUCKETS];
+    };
+    
+    StageStats stats[PROFILER_STAGES];
+    uint32_t cyclesPerMicro;
+    bool overlayEnabled;
+    
+    // FPS window
+    unsigned long fpsWindowStart;
+    uint8_t fpsFrames;
+    uint8_t fps;
+    
+    uint32_t toMicros(uint32_t cycleCount) { return cycleCount / cyclesPerMicro; }
+    uint32_t averageCycles(uint8_t stage) {
+      return stats[stage].count ? (uint32_t)(stats[stage].totalCycles / stats[stage].count) : 0;
+    }
+};
+
+extern Profiler profiler;
+
+// Times the rest of the enclosing block and charges it to a stage
+class ProfileScope {
+  public:
+    ProfileScope(uint8_t stage) : stage(stage), start(Profiler::cycles()) {}
+    ~ProfileScope() { profiler.record(stage, Profiler::cycles() - start); }
+    
+  private:
+    uint8_t stage;
+    uint32_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(stage)
+#define PROFILE_BEGIN(name) uint32_t name = Profiler::cycles()
+#define PROFILE_END(name, stage) profiler.record((stage), Profiler::cycles() - (name))
+#define PROFILE_FRAME(name) profiler.frameRendered(Profiler::cycles() - (name))
+#else
+#define PROFILE_SCOPE(stage)
+#define PROFILE_BEGIN(name)
+#define PROFILE_END(name, stage)
+#define PROFILE_FRAME(name)
+#endif
+
+#endif
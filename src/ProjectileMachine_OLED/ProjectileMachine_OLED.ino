@@ -4,6 +4,7 @@
  */
 
 #include <Wire.h>
+#include <Ticker.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "Config.h"
@@ -12,8 +13,25 @@
 #include "Beep.h"
 #include "Morse.h"
 #include "Physics.h"
+#include "Snapshot.h"
+#include "Terrain.h"
+#include "Salvo.h"
+#include "Targeting.h"
+#include "Envelope.h"
+#include "Ghosts.h"
+#include "Sweep.h"
+#include "Dispersion.h"
 #include "UI.h"
 #include "Assets.h"
+#include "Profiler.h"
+#include "Latency.h"
+#include "Governor.h"
+#include "Telemetry.h"
+#include "Batch.h"
+#include "Settings.h"
+#include "ResultsLog.h"
+#include "Power.h"
+#include "Coro.h"
 
 // Global objects
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire);
@@ -22,6 +40,13 @@ Beep buzzer;
 MorseInput morse;
 PhysicsEngine physics;
 UIRenderer ui(&display, &physics);
+QualityGovernor governor;
+Telemetry telemetry;
+BatchSolver batch;
+SettingsStore settingsStore;
+ResultsLog resultsLog;
+PowerManager power(&display);
+Ticker physicsTicker; // Steps the flight when PHYSICS_TICKER is set
 
 // State machine
 enum AppState {
@@ -32,13 +57,30 @@ enum AppState {
   STATE_ANGLE_ADJUST,
   STATE_VELOCITY_ADJUST,
   STATE_SIMULATION_RUN,
-  STATE_RESULTS
+  STATE_RESULTS,
+  STATE_LOG_SUMMARY,
+  STATE_SALVO_RUN,
+  STATE_SALVO_RESULTS,
+  STATE_TARGETING,
+  STATE_SWEEP
 };
 
 AppState currentState = STATE_BOOT_ANIM;
 AppState prevState = STATE_BOOT_ANIM;
 unsigned long stateEnterTime = 0;
 unsigned long lastFrameTime = 0;
+unsigned long lastFrameMicros = 0;
+unsigned long bootStartTime = 0;
+unsigned long bootReadyTime = 0; // First interactive frame on screen
+
+// Boot animation, Morse entry and flight run as coroutine flows
+CoroHandle stateFlow = 0; // Flow of the current state, if it has one
+
+// Events a flow can wait on
+enum FlowEvent {
+  EVENT_BUTTON = 1 << 0,      // buttonAction set this pass
+  EVENT_FLIGHT_STEP = 1 << 1  // Ticker published a step
+};
 
 // Input handling
 int buttonAction = 0; // 0=none, 1=up, 2=down, 3=enter, 4=long_enter
@@ -51,12 +93,56 @@ float launchVelocity = 20.0f;
 
 // Menu positions
 int gravityMenuPos = 0; // 0=Earth, 1=Moon, 2=Custom
+int presetCursor = 0; // Last preset loaded with long ENTER
 
 // Morse input buffer
 char morseInputBuffer[16] = "";
 
+// Hidden UP+DOWN chord toggles the perf overlay
+bool chordLatched = false;
+
+// Long ENTER on results flips between values and sensitivities
+bool sensitivityView = false;
+
+// Serial console line buffer
+char serialLine[SERIAL_LINE_LENGTH];
+uint8_t serialLineLength = 0;
+
+// Prototypes, so the sketch also builds as plain C++ on the host
+void pollSerialConsole();
+void handleSerialCommand(const char* cmd);
+void enterState(AppState newState);
+LaunchSettings currentSettings();
+void applySettings(const LaunchSettings& settings);
+void loadPreset(uint8_t slot);
+void loadNextPreset();
+bool isStaticState(AppState state);
+CoroStatus bootAnimationFlow(CoroFrame& f, unsigned long now);
+void stateHeightSelect();
+void stateGravityMenu();
+CoroStatus morseEntryFlow(CoroFrame& f, unsigned long now);
+bool handleMorseKey();
+void stateAngleAdjust();
+void stateVelocityAdjust();
+void onPhysicsTick();
+CoroStatus flightFlow(CoroFrame& f, unsigned long now);
+void stepFlight(unsigned long now);
+bool followFlight(uint32_t& stepsSeen, int& pathPoints);
+void finishFlight();
+void stateResults();
+void stateLogSummary();
+void stateSalvoRun(unsigned long now);
+void stateSalvoResults();
+void printSalvoResults();
+void stateTargeting();
+void printTargetSolution();
+void stateSweep();
+void printSensitivities();
+
 void setup() {
-  Serial.begin(115200);
+  bootStartTime = millis();
+  bootReadyTime = 0;
+  Serial.begin(SERIAL_BAUD);
   Serial.println(F("ProjectileMachine_OLED starting..."));
   
   // Initialize OLED
@@ -71,20 +157,57 @@ void setup() {
   // Initialize components
   buttons.begin();
   buzzer.begin();
+  terrain.begin();
+  obstacles.begin();
   physics.begin();
+  flightSnapshots.begin();
+  salvo.begin();
+  targeting.begin();
+  envelope.begin();
+  ghosts.begin();
+  sweep.begin();
+  dispersion.begin();
   ui.begin();
+  profiler.begin();
+  latency.begin();
+  governor.begin();
+  telemetry.begin();
+  settingsStore.begin();
+  resultsLog.begin();
+  power.begin();
+  coroutines.begin();
   
-  // Start with boot animation
-  enterState(STATE_BOOT_ANIM);
+  // Fast boot straight into the last session, unless ENTER is held
+  LaunchSettings session;
+  if (FAST_BOOT_ENABLED && digitalRead(BUTTON_ENTER) == HIGH &&
+      settingsStore.load(SESSION_SLOT, session)) {
+    applySettings(session);
+    enterState(STATE_ANGLE_ADJUST);
+  } else {
+    // Start with boot animation
+    enterState(STATE_BOOT_ANIM);
+  }
   
   Serial.println(F("Initialization complete"));
 }
 
 void loop() {
+  // Batch mode owns the Serial port and skips the interactive loop
+  if (batch.isActive()) {
+    batch.poll();
+    return;
+  }
+  
   unsigned long now = millis();
+  unsigned long loopStartMicros = micros();
+  PROFILE_BEGIN(loopStart);
+  
+  pollSerialConsole();
   
   // Update buttons
+  PROFILE_BEGIN(buttonsStart);
   buttons.update();
+  PROFILE_END(buttonsStart, STAGE_BUTTONS);
   buttonAction = 0;
   
   // Check for button presses
@@ -101,6 +224,7 @@ void loop() {
     buttonAction = 4;
     buzzer.beep(BEEP_LONG);
   }
+  ButtonEvent inputEvent = buttons.getEvent();
   
   // Handle button hold repeat
   if (buttons.isHeld(BUTTON_UP)) {
@@ -109,10 +233,32 @@ void loop() {
     buttonAction = 2;
   }
   
+  // Perf overlay chord swallows the input it was made with
+  bool chord = buttons.isPressed(BUTTON_UP) && buttons.isPressed(BUTTON_DOWN);
+  if (chord) {
+    if (!chordLatched) {
+      profiler.toggleOverlay();
+    }
+    buttonAction = 0;
+  }
+  chordLatched = chord;
+  
+  // Input resets the inactivity timers; a press that wakes a blank panel does nothing else
+  bool buttonDown = buttons.isPressed(BUTTON_UP) || buttons.isPressed(BUTTON_DOWN) ||
+                    buttons.isPressed(BUTTON_ENTER);
+  if (power.update(now, buttonDown, buttonAction != 0)) {
+    buttonAction = 0;
+  }
+  
   // State machine
+  uint8_t handledState = currentState;
+  PROFILE_BEGIN(handlerStart);
   switch (currentState) {
     case STATE_BOOT_ANIM:
-      stateBootAnimation(now);
+    case STATE_MORSE_INPUT:
+    case STATE_SIMULATION_RUN:
+      // Flows resume only when their wake time or an awaited event comes
+      coroutines.run(now, buttonAction ? EVENT_BUTTON : 0);
       break;
     case STATE_HEIGHT_SELECT:
       stateHeightSelect();
@@ -120,31 +266,183 @@ void loop() {
     case STATE_GRAVITY_MENU:
       stateGravityMenu();
       break;
-    case STATE_MORSE_INPUT:
-      stateMorseInput();
-      break;
     case STATE_ANGLE_ADJUST:
       stateAngleAdjust();
       break;
     case STATE_VELOCITY_ADJUST:
       stateVelocityAdjust();
       break;
-    case STATE_SIMULATION_RUN:
-      stateSimulationRun(now);
-      break;
     case STATE_RESULTS:
       stateResults();
       break;
+    case STATE_LOG_SUMMARY:
+      stateLogSummary();
+      break;
+    case STATE_SALVO_RUN:
+      stateSalvoRun(now);
+      break;
+    case STATE_SALVO_RESULTS:
+      stateSalvoResults();
+      break;
+    case STATE_TARGETING:
+      stateTargeting();
+      break;
+    case STATE_SWEEP:
+      stateSweep();
+      break;
   }
+  PROFILE_END(handlerStart, PROFILE_HANDLER_STAGE(handledState));
   
-  // Render at target FPS
-  if (now - lastFrameTime >= FRAME_TIME_MS) {
+  // Follow the edge behind this pass's input through to the panel
+  if (buttonAction != 0) latency.handled(inputEvent, handledState, micros());
+  
+  // Render at target FPS, or a fraction of it when the governor sheds load.
+  // Static screens slow down when idle but redraw at once on input.
+  unsigned long framePeriod = power.getFramePeriod(isStaticState(currentState),
+                                                   BUILD.frameTimeMs * governor.getRenderDivider());
+  bool redrawNow = buttonAction != 0 || currentState != handledState;
+  if (!power.isBlanked() && (now - lastFrameTime >= framePeriod || redrawNow)) {
+    ui.setQualityLevel(governor.getLevel());
     ui.render(currentState);
     lastFrameTime = now;
+    
+    if (bootReadyTime == 0 && currentState != STATE_BOOT_ANIM) {
+      bootReadyTime = millis();
+      Serial.print(F("Ready in "));
+      Serial.print(bootReadyTime - bootStartTime);
+      Serial.println(F(" ms"));
+    }
+    PROFILE_FRAME(loopStart);
+    lastFrameMicros = micros() - loopStartMicros;
+    governor.reportFrame(lastFrameMicros);
   }
   
   // Update buzzer
   buzzer.update();
+  
+  // Drain queued telemetry frames into the UART
+  telemetry.pump();
+  
+  // Batched flash writes and log export
+  resultsLog.poll(now);
+  
+  // Wait or sleep until the next frame or button poll
+  bool canIdle = isStaticState(currentState) && telemetry.isDrained() && !resultsLog.isExporting();
+  power.idle(handledState, canIdle, lastFrameTime + framePeriod);
+}
+
+void pollSerialConsole() {
+  // Stop at a mode switch so batch mode sees the rest of the input
+  while (Serial.available() > 0 && !batch.isActive()) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+    
+    if (c == '\n') {
+      serialLine[serialLineLength] = '\0';
+      handleSerialCommand(serialLine);
+      serialLineLength = 0;
+    } else if (serialLineLength < SERIAL_LINE_LENGTH - 1) {
+      serialLine[serialLineLength++] = c;
+    }
+  }
+}
+
+void handleSerialCommand(const char* cmd) {
+  if (strcmp(cmd, "perf") == 0) {
+    profiler.dump(Serial);
+  } else if (strcmp(cmd, "perf reset") == 0) {
+    profiler.reset();
+  } else if (strcmp(cmd, "latency") == 0) {
+    latency.dump(Serial);
+  } else if (strcmp(cmd, "latency reset") == 0) {
+    latency.reset();
+  } else if (strcmp(cmd, "overlay") == 0) {
+    profiler.toggleOverlay();
+  } else if (strcmp(cmd, "quality") == 0) {
+    Serial.print(F("quality "));
+    Serial.print(governor.getLevel());
+    Serial.print(F(" changes "));
+    Serial.println(governor.getLevelChanges());
+  } else if (strcmp(cmd, "presets") == 0) {
+    settingsStore.list(Serial);
+  } else if (strncmp(cmd, "save ", 5) == 0) {
+    // save <slot> [name]
+    const char* name = strchr(cmd + 5, ' ');
+    int slot = atoi(cmd + 5);
+    if (slot >= 1 && slot <= PRESET_SLOTS &&
+        settingsStore.save(slot, currentSettings(), name ? name + 1 : "")) {
+      Serial.println(F("OK"));
+    } else {
+      Serial.println(F("ERR"));
+    }
+  } else if (strncmp(cmd, "load ", 5) == 0) {
+    loadPreset(atoi(cmd + 5));
+  } else if (strcmp(cmd, "log") == 0) {
+    LogSummary summary = resultsLog.getSummary();
+    Serial.print(F("shots "));
+    Serial.print(summary.count);
+    Serial.print(F(" best "));
+    Serial.print(summary.bestRange, 2);
+    Serial.print(F(" avg_range "));
+    Serial.print(summary.avgRange, 2);
+    Serial.print(F(" avg_height "));
+    Serial.print(summary.avgMaxHeight, 2);
+    Serial.print(F(" avg_time "));
+    Serial.println(summary.avgFlightTime, 2);
+  } else if (strcmp(cmd, "export") == 0) {
+    resultsLog.startExport();
+  } else if (strcmp(cmd, "salvo") == 0) {
+    printSalvoResults();
+  } else if (strcmp(cmd, "salvo angle") == 0) {
+    salvo.setMode(SALVO_ANGLES);
+  } else if (strcmp(cmd, "salvo velocity") == 0) {
+    salvo.setMode(SALVO_VELOCITIES);
+  } else if (strcmp(cmd, "salvo gravity") == 0) {
+    salvo.setMode(SALVO_GRAVITIES);
+  } else if (strncmp(cmd, "target ", 7) == 0) {
+    // target <distance> [height]; the height defaults to the ground there
+    float distance = atof(cmd + 7);
+    const char* height = strchr(cmd + 7, ' ');
+    targeting.setTarget(distance, height ? atof(height + 1) : terrain.heightAt(distance));
+    enterState(STATE_TARGETING);
+  } else if (strcmp(cmd, "envelope") == 0) {
+    envelope.setEnabled(!envelope.isEnabled());
+    envelope.update(initialHeight, gravity, launchVelocity);
+    Serial.print(F("envelope "));
+    Serial.print(envelope.isEnabled() ? F("on") : F("off"));
+    Serial.print(F(" max_range "));
+    Serial.print(envelope.getMaxRange(), 2);
+    Serial.print(F(" at "));
+    Serial.print(envelope.getOptimalAngle(), 2);
+    if (!SafetyEnvelope::isUpperBound()) Serial.print(F(" vacuum_only"));
+    Serial.println();
+  } else if (strcmp(cmd, "dispersion") == 0) {
+    Serial.print(F("dispersion "));
+    Serial.print(dispersion.getCount());
+    Serial.print(F(" mean "));
+    Serial.print(dispersion.getMean(), 2);
+    Serial.print(F(" sigma "));
+    Serial.print(dispersion.getSigma(), 2);
+    Serial.print(F(" cep "));
+    Serial.println(dispersion.getCep(), 2);
+  } else if (strcmp(cmd, "sensitivity") == 0) {
+    printSensitivities();
+  } else if (strcmp(cmd, "power") == 0) {
+    power.dump(Serial);
+  } else if (strcmp(cmd, "boot") == 0) {
+    Serial.print(F("ready "));
+    Serial.print(bootReadyTime - bootStartTime);
+    Serial.println(F(" ms"));
+  } else if (strcmp(cmd, "batch") == 0) {
+    batch.begin();
+  } else if (strcmp(cmd, "telem on") == 0) {
+    telemetry.setEnabled(true);
+  } else if (strcmp(cmd, "telem off") == 0) {
+    telemetry.setEnabled(false);
+  } else if (cmd[0] != '\0') {
+    Serial.print(F("Unknown command: "));
+    Serial.println(cmd);
+  }
 }
 
 void enterState(AppState newState) {
@@ -154,52 +452,134 @@ void enterState(AppState newState) {
   Serial.print(F("Entering state: "));
   Serial.println(newState);
   
+  // The engine only moves while its flight is on screen
+  if (prevState == STATE_SIMULATION_RUN) {
+    physicsTicker.detach();
+  }
+  
+  // A flow ends with its state, wherever it had got to
+  coroutines.stop(stateFlow);
+  stateFlow = 0;
+  
   // State-specific initialization
+  // Height, angle and velocity carry over between shots
   switch (newState) {
-    case STATE_HEIGHT_SELECT:
-      initialHeight = 0.0f;
+    case STATE_BOOT_ANIM:
+      stateFlow = coroutines.start(bootAnimationFlow, stateEnterTime);
       break;
     case STATE_GRAVITY_MENU:
       gravityMenuPos = 0;
       break;
     case STATE_MORSE_INPUT:
-      morse.begin();
-      strcpy(morseInputBuffer, "");
+      stateFlow = coroutines.start(morseEntryFlow, stateEnterTime);
       break;
     case STATE_ANGLE_ADJUST:
-      launchAngle = 45.0f;
       physics.setParameters(initialHeight, gravity, launchAngle, launchVelocity);
+      envelope.update(initialHeight, gravity, launchVelocity);
       ui.setCannonMouthPosition(launchAngle, initialHeight);
       break;
     case STATE_VELOCITY_ADJUST:
       physics.setParameters(initialHeight, gravity, launchAngle, launchVelocity);
+      envelope.update(initialHeight, gravity, launchVelocity);
       ui.setCannonMouthPosition(launchAngle, initialHeight);
       break;
     case STATE_SIMULATION_RUN:
       physics.startSimulation(initialHeight, gravity, launchAngle, launchVelocity);
+      publishFlight(physics);
+      if (PHYSICS_TICKER) {
+        physicsTicker.attach_ms(PHYSICS_STEP_MS, onPhysicsTick);
+      }
+      settingsStore.save(SESSION_SLOT, currentSettings());
+      telemetry.sendLaunch(initialHeight, gravity, launchAngle, launchVelocity);
       buzzer.startFlightBeep();
       ui.setCannonMouthPosition(launchAngle, initialHeight);
+      stateFlow = coroutines.start(flightFlow, stateEnterTime);
+      break;
+    case STATE_RESULTS:
+      // Same launch as last time keeps the dispersion already flown
+      dispersion.setLaunch(currentSettings());
+      ui.setSensitivities(PhysicsEngine::sensitivities(initialHeight, gravity, launchAngle, launchVelocity));
+      break;
+    case STATE_LOG_SUMMARY:
+      ui.setLogSummary(resultsLog.getSummary());
+      break;
+    case STATE_SALVO_RUN:
+      salvo.launch(initialHeight, gravity, launchAngle, launchVelocity);
+      buzzer.startFlightBeep();
+      break;
+    case STATE_SALVO_RESULTS:
+      printSalvoResults();
+      break;
+    case STATE_TARGETING:
+      targeting.update(initialHeight, gravity, launchVelocity);
+      printTargetSolution();
+      break;
+    case STATE_SWEEP:
+      sweep.setLaunch(initialHeight, gravity);
       break;
   }
 }
 
-void stateBootAnimation(unsigned long now) {
-  static unsigned int animPhase = 0;
-  static unsigned long lastAnimUpdate = 0;
-  
-  unsigned long elapsed = now - stateEnterTime;
-  
-  if (elapsed > BOOT_ANIM_DURATION) {
-    enterState(STATE_HEIGHT_SELECT);
+bool isStaticState(AppState state) {
+  // Everything but the animated screens, and the sweep and dispersion
+  // while they fill in, only changes on input
+  return state != STATE_BOOT_ANIM && state != STATE_SIMULATION_RUN &&
+         state != STATE_SALVO_RUN && (state != STATE_SWEEP || sweep.isComplete()) &&
+         (state != STATE_RESULTS || dispersion.isComplete());
+}
+
+LaunchSettings currentSettings() {
+  LaunchSettings settings = {initialHeight, gravity, launchAngle, launchVelocity};
+  return settings;
+}
+
+void applySettings(const LaunchSettings& settings) {
+  initialHeight = constrain(settings.height, MIN_HEIGHT, MAX_HEIGHT);
+  gravity = constrain(settings.gravity, MIN_GRAVITY, MAX_GRAVITY);
+  launchAngle = constrain(settings.angle, MIN_ANGLE, MAX_ANGLE);
+  launchVelocity = constrain(settings.velocity, MIN_VELOCITY, MAX_VELOCITY);
+  ui.setHeight(initialHeight);
+}
+
+void loadPreset(uint8_t slot) {
+  LaunchSettings preset;
+  if (slot < 1 || !settingsStore.load(slot, preset)) {
+    Serial.println(F("ERR"));
+    buzzer.error();
     return;
   }
   
-  // Update animation every 50ms
-  if (now - lastAnimUpdate > 50) {
-    animPhase = (animPhase + 1) % 24;
-    lastAnimUpdate = now;
-    ui.setBootAnimationPhase(animPhase);
+  presetCursor = slot;
+  applySettings(preset);
+  Serial.print(F("Preset "));
+  Serial.print(slot);
+  Serial.print(' ');
+  Serial.println(settingsStore.getName(slot));
+  enterState(STATE_ANGLE_ADJUST);
+}
+
+void loadNextPreset() {
+  for (int i = 1; i <= PRESET_SLOTS; i++) {
+    int slot = (presetCursor + i - 1) % PRESET_SLOTS + 1;
+    if (settingsStore.isValid(slot)) {
+      loadPreset(slot);
+      return;
+    }
+  }
+  buzzer.error();
+}
+
+CoroStatus bootAnimationFlow(CoroFrame& f, unsigned long now) {
+  unsigned int& phase = f.locals<unsigned int>();
+  
+  CORO_BEGIN(f);
+  for (phase = 0; now - stateEnterTime <= BOOT_ANIM_DURATION; phase = (phase + 1) % 24) {
+    ui.setBootAnimationPhase(phase);
+    // Next phase, or the first millisecond past the animation
+    CORO_SLEEP_UNTIL(f, min(now + BOOT_ANIM_FRAME_MS, stateEnterTime + BOOT_ANIM_DURATION + 1));
   }
+  enterState(STATE_HEIGHT_SELECT);
+  CORO_END(f);
 }
 
 void stateHeightSelect() {
@@ -211,9 +591,11 @@ void stateHeightSelect() {
       initialHeight = max(initialHeight - HEIGHT_STEP, MIN_HEIGHT);
       break;
     case 3: // ENTER
-    case 4: // LONG ENTER
       enterState(STATE_GRAVITY_MENU);
       break;
+    case 4: // LONG ENTER: cycle saved presets
+      loadNextPreset();
+      break;
   }
   
   // Update UI
@@ -251,7 +633,21 @@ void stateGravityMenu() {
   ui.setGravityMenu(gravityMenuPos);
 }
 
-void stateMorseInput() {
+CoroStatus morseEntryFlow(CoroFrame& f, unsigned long) {
+  CORO_BEGIN(f);
+  morse.begin();
+  strcpy(morseInputBuffer, "");
+  ui.setMorseInput(morseInputBuffer, morse.getCurrentSequence());
+  do {
+    CORO_AWAIT(f, EVENT_BUTTON);
+  } while (!handleMorseKey());
+  enterState(STATE_ANGLE_ADJUST);
+  CORO_END(f);
+}
+
+// True once a valid gravity has been entered
+bool handleMorseKey() {
+  bool done = false;
   switch (buttonAction) {
     case 1: // UP (dot)
       morse.addSymbol('.');
@@ -270,9 +666,9 @@ void stateMorseInput() {
             float customGravity = atof(morseInputBuffer);
             if (customGravity >= 0.1f && customGravity <= 20.0f) {
               gravity = customGravity;
-              enterState(STATE_ANGLE_ADJUST);
+              done = true;
             } else {
-              buzzer.beep(BEEP_ERROR);
+              buzzer.error();
               strcpy(morseInputBuffer, "");
               morse.begin();
             }
@@ -290,11 +686,12 @@ void stateMorseInput() {
     case 4: // LONG ENTER (clear)
       strcpy(morseInputBuffer, "");
       morse.begin();
-      buzzer.beep(BEEP_ERROR);
+      buzzer.error();
       break;
   }
   
   ui.setMorseInput(morseInputBuffer, morse.getCurrentSequence());
+  return done;
 }
 
 void stateAngleAdjust() {
@@ -312,6 +709,13 @@ void stateAngleAdjust() {
     case 3: // ENTER
       enterState(STATE_VELOCITY_ADJUST);
       break;
+    case 4: { // LONG ENTER
+      // Start targeting from where the current shot lands
+      Point landing = physics.getPrediction()[max(physics.getPredictionPoints() - 1, 0)];
+      targeting.setTarget(round(landing.x), terrain.heightAt(round(landing.x)));
+      enterState(STATE_TARGETING);
+      break;
+    }
   }
   
   ui.setAngle(launchAngle);
@@ -322,61 +726,271 @@ void stateVelocityAdjust() {
     case 1: // UP
       launchVelocity = min(launchVelocity + VELOCITY_STEP, MAX_VELOCITY);
       physics.setParameters(initialHeight, gravity, launchAngle, launchVelocity);
+      envelope.update(initialHeight, gravity, launchVelocity);
       ui.setCannonMouthPosition(launchAngle, initialHeight);
       break;
     case 2: // DOWN
       launchVelocity = max(launchVelocity - VELOCITY_STEP, MIN_VELOCITY);
       physics.setParameters(initialHeight, gravity, launchAngle, launchVelocity);
+      envelope.update(initialHeight, gravity, launchVelocity);
       ui.setCannonMouthPosition(launchAngle, initialHeight);
       break;
     case 3: // ENTER
       enterState(STATE_SIMULATION_RUN);
       break;
+    case 4: // LONG ENTER
+      enterState(STATE_SALVO_RUN);
+      break;
   }
   
   ui.setVelocity(launchVelocity);
 }
 
-void stateSimulationRun(unsigned long now) {
-  static bool pathDrawn[MAX_PREDICTION_POINTS] = {false};
-  static int currentPathIndex = 0;
-  
-  physics.update(now);
+void onPhysicsTick() {
+  // Timer context: one fixed step, then a fresh snapshot for the loop
+  if (physics.isSimulationComplete()) return;
+  physics.run(1);
+  publishFlight(physics);
+  coroutines.post(EVENT_FLIGHT_STEP);
+}
+
+CoroStatus flightFlow(CoroFrame& f, unsigned long now) {
+  struct Locals {
+    uint32_t stepsSeen;
+    int pathPoints;
+  };
+  Locals& l = f.locals<Locals>();
   
-  // Update dotted path
-  Point currentPos = physics.getCurrentPosition();
-  if (currentPathIndex < MAX_PREDICTION_POINTS - 1) {
-    // Mark current position as part of the dotted path
-    ui.addDottedPathPoint(currentPos.x, currentPos.y);
-    currentPathIndex++;
+  CORO_BEGIN(f);
+  l.stepsSeen = 0;
+  l.pathPoints = 0;
+  ui.clearDottedPath();
+  ui.setSimulationData(&flightSnapshots.acquire());
+  do {
+    // From the loop, sleep to the next fixed step; a Ticker posts each one
+    if (PHYSICS_TICKER) {
+      CORO_AWAIT(f, EVENT_FLIGHT_STEP);
+    } else {
+      CORO_SLEEP_UNTIL(f, physics.getNextStepTime());
+      stepFlight(now);
+    }
+  } while (!followFlight(l.stepsSeen, l.pathPoints));
+  finishFlight();
+  CORO_END(f);
+}
+
+void stepFlight(unsigned long now) {
+  PROFILE_BEGIN(physicsStart);
+  if (physics.update(now) > 0) {
+    publishFlight(physics);
   }
+  PROFILE_END(physicsStart, STAGE_PHYSICS);
+}
+
+// Takes in the newest snapshot; true once the flight is over
+bool followFlight(uint32_t& stepsSeen, int& pathPoints) {
+  // Mid-flight the engine is only read through its snapshots
+  const FlightSnapshot& flight = flightSnapshots.acquire();
+  ui.setSimulationData(&flight);
+  if (flight.stepCount == stepsSeen) return flight.complete;
   
-  if (physics.isSimulationComplete()) {
-    buzzer.stopFlightBeep();
-    enterState(STATE_RESULTS);
-    // Reset path drawing for next simulation
-    for (int i = 0; i < MAX_PREDICTION_POINTS; i++) {
-      pathDrawn[i] = false;
+  buzzer.setFlightVelocity(flight.velocity.y);
+  
+  // Each physics step is sent as a tick and gets a dotted path point,
+  // including every step a slow frame made the engine catch up on
+  for (uint32_t n = stepsSeen + 1; n <= flight.stepCount; n++) {
+    const StepRecord* step = flight.step(n);
+    if (!step) continue;
+    telemetry.sendTick(n, step->position, step->velocity, currentState, lastFrameMicros);
+    if (pathPoints < BUILD.predictionPoints - 1) {
+      ui.addDottedPathPoint(step->position.x, step->position.y);
+      pathPoints++;
     }
-    currentPathIndex = 0;
-    ui.clearDottedPath();
   }
+  stepsSeen = flight.stepCount;
+  return flight.complete;
+}
+
+// A complete flight no longer changes, so its results are read directly
+void finishFlight() {
+  buzzer.stopFlightBeep();
+  telemetry.sendResult(physics.getTotalRange(), physics.getMaxHeight(), physics.getFlightTime());
+  ShotResult result = {physics.getTotalRange(), physics.getMaxHeight(), physics.getFlightTime()};
+  resultsLog.append(initialHeight, gravity, launchAngle, launchVelocity, result);
+  
+  // The ghost keeps the first arc, cut short if an obstacle stopped it
+  float arcTime = PhysicsEngine::solveOverTerrain(initialHeight, gravity, launchAngle, launchVelocity).flightTime;
+  ghosts.record(initialHeight, gravity, launchAngle, launchVelocity, min(arcTime, physics.getFlightTime()));
   
-  ui.setSimulationData(physics.getCurrentPosition(), 
-                       physics.getCurrentVelocity(),
-                       physics.getTrail(),
-                       physics.getTrailLength());
+  if (physics.getTargetHits() > 0 || physics.getStoppedBy() >= 0) {
+    Serial.print(F("targets "));
+    Serial.print(physics.getTargetHits());
+    Serial.print(F(" stopped "));
+    Serial.println(physics.getStoppedBy());
+  }
+  enterState(STATE_RESULTS);
+  ui.clearDottedPath();
 }
 
 void stateResults() {
+  PROFILE_BEGIN(dispersionStart);
+  dispersion.update(DISPERSION_SLICE_US);
+  PROFILE_END(dispersionStart, STAGE_PHYSICS);
+  
   switch (buttonAction) {
+    case 1: // UP
+      enterState(STATE_LOG_SUMMARY);
+      break;
+    case 2: // DOWN
+      enterState(STATE_SWEEP);
+      break;
     case 3: // ENTER
-    case 4: // LONG ENTER
       enterState(STATE_HEIGHT_SELECT);
       break;
+    case 4: // LONG ENTER
+      sensitivityView = !sensitivityView;
+      ui.setSensitivityView(sensitivityView);
+      break;
   }
   
   ui.setResults(physics.getMaxHeight(), 
                 physics.getTotalRange(), 
-                physics.getFlightTime());
+                physics.getFlightTime(),
+                physics.getBounceCount(),
+                physics.getTargetHits());
+}
+
+void printSensitivities() {
+  // Partial derivatives of each result, first landing in vacuum
+  ShotSensitivity s = PhysicsEngine::sensitivities(initialHeight, gravity, launchAngle, launchVelocity);
+  const Sensitive* results[] = {&s.range, &s.maxHeight, &s.flightTime};
+  const char* names[] = {"range", "max_height", "time"};
+  for (int i = 0; i < 3; i++) {
+    Serial.print(names[i]);
+    Serial.print(' ');
+    Serial.print(results[i]->v, 3);
+    Serial.print(F(" d_angle "));
+    Serial.print(results[i]->d[SENS_ANGLE], 4);
+    Serial.print(F(" d_velocity "));
+    Serial.print(results[i]->d[SENS_VELOCITY], 4);
+    Serial.print(F(" d_height "));
+    Serial.print(results[i]->d[SENS_HEIGHT], 4);
+    Serial.print(F(" d_gravity "));
+    Serial.println(results[i]->d[SENS_GRAVITY], 4);
+  }
+}
+
+void stateSweep() {
+  PROFILE_BEGIN(sweepStart);
+  sweep.update(SWEEP_SLICE_US);
+  PROFILE_END(sweepStart, STAGE_PHYSICS);
+  
+  switch (buttonAction) {
+    case 1: // UP
+    case 2: // DOWN
+      sweep.nextMetric();
+      break;
+    case 3: // ENTER
+    case 4: // LONG ENTER
+      enterState(STATE_RESULTS);
+      break;
+  }
+  
+  ui.setAngle(launchAngle);
+  ui.setVelocity(launchVelocity);
+}
+
+void stateSalvoRun(unsigned long now) {
+  PROFILE_BEGIN(physicsStart);
+  salvo.update(now);
+  PROFILE_END(physicsStart, STAGE_PHYSICS);
+  
+  if (salvo.isComplete()) {
+    buzzer.stopFlightBeep();
+    enterState(STATE_SALVO_RESULTS);
+  }
+}
+
+void stateSalvoResults() {
+  switch (buttonAction) {
+    case 2: // DOWN
+      salvo.setMode((SalvoMode)((salvo.getMode() + 1) % SALVO_MODES));
+      break;
+    case 3: // ENTER
+    case 4: // LONG ENTER
+      enterState(STATE_VELOCITY_ADJUST);
+      break;
+  }
+}
+
+void printSalvoResults() {
+  for (int i = 0; i < salvo.getCount(); i++) {
+    ShotResult result = salvo.getResult(i);
+    Serial.print(F("shot "));
+    Serial.print(i);
+    Serial.print(' ');
+    Serial.print(salvo.getParameter(i), 2);
+    Serial.print(' ');
+    Serial.print(result.range, 2);
+    Serial.print(' ');
+    Serial.print(result.maxHeight, 2);
+    Serial.print(' ');
+    Serial.println(result.flightTime, 2);
+  }
+}
+
+void stateTargeting() {
+  switch (buttonAction) {
+    case 1: // UP
+    case 2: { // DOWN
+      float distance = targeting.getDistance() + (buttonAction == 1 ? TARGET_STEP : -TARGET_STEP);
+      targeting.setTarget(distance, terrain.heightAt(distance));
+      targeting.update(initialHeight, gravity, launchVelocity);
+      break;
+    }
+    case 3: { // ENTER
+      // Take the chosen solution back to angle adjustment
+      float angle, velocity;
+      if (targeting.getChoiceLaunch(launchVelocity, angle, velocity)) {
+        launchAngle = angle;
+        launchVelocity = velocity;
+        printTargetSolution();
+        enterState(STATE_ANGLE_ADJUST);
+      } else {
+        buzzer.error();
+      }
+      break;
+    }
+    case 4: // LONG ENTER
+      targeting.nextChoice();
+      break;
+  }
+}
+
+void printTargetSolution() {
+  TargetSolution solution = targeting.getSolution();
+  Serial.print(F("target "));
+  Serial.print(targeting.getDistance(), 2);
+  Serial.print(' ');
+  Serial.print(targeting.getHeight(), 2);
+  if (solution.reachable) {
+    Serial.print(F(" low "));
+    Serial.print(solution.lowAngle, 2);
+    Serial.print(F(" high "));
+    Serial.print(solution.highAngle, 2);
+  } else {
+    Serial.print(F(" unreachable"));
+  }
+  Serial.print(F(" vmin "));
+  Serial.print(solution.minVelocity, 2);
+  Serial.print(F(" at "));
+  Serial.println(solution.minVelocityAngle, 2);
+}
+
+void stateLogSummary() {
+  switch (buttonAction) {
+    case 3: // ENTER
+      enterState(STATE_RESULTS);
+      break;
+  }
 }
\ No newline at end of file
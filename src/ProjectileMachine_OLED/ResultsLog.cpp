@@ -0,0 +1,226 @@
+/**
+ * Results log implementation
+ */
+
+#include "ResultsLog.h"
+#include "Crc.h"
+#include <LittleFS.h>
+
+static const uint16_t RECORD_MAGIC = 0x4C52; // "RL"
+static const char* CURRENT_PATH = "/results.log";
+static const char* PREVIOUS_PATH = "/results.old";
+
+// Longest CSV line for one record
+static const int EXPORT_LINE_MAX = 96;
+
+void ResultsLog::begin() {
+  nextSequence = 1;
+  currentRecords = 0;
+  pendingCount = 0;
+  writeFailed = false;
+  resetSummary();
+  exportFile = -1;
+  exportOffset = 0;
+  exported = 0;
+  
+  // SettingsStore has already mounted the filesystem; begin() is idempotent
+  mounted = LittleFS.begin();
+  if (!mounted) return;
+  
+  scanFile(PREVIOUS_PATH, false);
+  scanFile(CURRENT_PATH, true);
+}
+
+void ResultsLog::scanFile(const char* path, bool current) {
+  File f = LittleFS.open(path, "r");
+  if (!f) return;
+  
+  Record rec;
+  while (f.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec)) {
+    if (current) currentRecords++;
+    if (rec.magic != RECORD_MAGIC || recordCrc(rec) != rec.crc) continue;
+    
+    addToSummary(rec);
+    if (rec.sequence >= nextSequence) {
+      nextSequence = rec.sequence + 1;
+    }
+  }
+  f.close();
+}
+
+void ResultsLog::append(float height, float gravity, float angle, float velocity, const ShotResult& result) {
+  if (pendingCount == RESULTS_LOG_BATCH) {
+    flush();
+  }
+  // Flash still refusing writes and the batch is full: the shot is not logged
+  if (pendingCount == RESULTS_LOG_BATCH) return;
+  
+  Record& rec = pending[pendingCount];
+  rec.magic = RECORD_MAGIC;
+  rec.sequence = nextSequence++;
+  rec.height = height;
+  rec.gravity = gravity;
+  rec.angle = angle;
+  rec.velocity = velocity;
+  rec.range = result.range;
+  rec.maxHeight = result.maxHeight;
+  rec.flightTime = result.flightTime;
+  rec.crc = recordCrc(rec);
+  
+  if (pendingCount == 0) {
+    pendingSince = millis();
+  }
+  pendingCount++;
+  addToSummary(rec);
+}
+
+void ResultsLog::poll(unsigned long now) {
+  // After a failed write, wait a full flush period before trying again
+  bool due = now - pendingSince >= RESULTS_LOG_FLUSH_MS;
+  if (!writeFailed && pendingCount == RESULTS_LOG_BATCH) due = true;
+  if (pendingCount > 0 && due) {
+    flush();
+  }
+  
+  if (exportFile < 0) return;
+  
+  // One record per pass, and only when the UART can take a full line
+  if (Serial.availableForWrite() < EXPORT_LINE_MAX) return;
+  
+  Record rec;
+  while (!readNextExportRecord(rec)) {
+    exportOffset = 0;
+    if (++exportFile > 1) {
+      exportFile = -1;
+      Serial.print(F("OK export "));
+      Serial.println(exported);
+      return;
+    }
+  }
+  
+  Serial.print(rec.sequence);
+  Serial.print(',');
+  Serial.print(rec.height, 2);
+  Serial.print(',');
+  Serial.print(rec.gravity, 2);
+  Serial.print(',');
+  Serial.print(rec.angle, 1);
+  Serial.print(',');
+  Serial.print(rec.velocity, 1);
+  Serial.print(',');
+  Serial.print(rec.range, 3);
+  Serial.print(',');
+  Serial.print(rec.maxHeight, 3);
+  Serial.print(',');
+  Serial.println(rec.flightTime, 3);
+  exported++;
+}
+
+void ResultsLog::flush() {
+  if (!mounted || pendingCount == 0) return;
+  
+  uint8_t written = 0;
+  while (written < pendingCount) {
+    if (currentRecords >= RESULTS_LOG_MAX_RECORDS) {
+      rotate(written);
+    }
+    
+    // Write as much of the batch as fits in the current file
+    uint8_t chunk = min(pendingCount - written, RESULTS_LOG_MAX_RECORDS - currentRecords);
+    File f = LittleFS.open(CURRENT_PATH, "a");
+    if (!f) break;
+    size_t start = f.size();
+    size_t bytes = chunk * sizeof(Record);
+    size_t landed = f.write((const uint8_t*)&pending[written], bytes);
+    if (landed != bytes) {
+      // Short write (flash full): keep the whole records that made it and
+      // cut off any partial one, so fixed-size reads stay aligned
+      chunk = landed / sizeof(Record);
+      f.truncate(start + chunk * sizeof(Record));
+    }
+    f.close();
+    
+    written += chunk;
+    currentRecords += chunk;
+    if (landed != bytes) break;
+  }
+  
+  // Whatever was not written is kept for the next attempt
+  for (uint8_t i = written; i < pendingCount; i++) {
+    pending[i - written] = pending[i];
+  }
+  pendingCount -= written;
+  writeFailed = pendingCount > 0;
+  if (writeFailed) {
+    pendingSince = millis();
+  }
+}
+
+void ResultsLog::rotate(uint8_t unwritten) {
+  LittleFS.remove(PREVIOUS_PATH);
+  LittleFS.rename(CURRENT_PATH, PREVIOUS_PATH);
+  currentRecords = 0;
+  
+  // The deleted file's shots leave the summary: what remains is the
+  // file just moved aside and the pending records from unwritten on
+  resetSummary();
+  scanFile(PREVIOUS_PATH, false);
+  for (uint8_t i = unwritten; i < pendingCount; i++) {
+    addToSummary(pending[i]);
+  }
+}
+
+void ResultsLog::startExport() {
+  flush();
+  
+  Serial.println(F("seq,h0,g,angle,v0,range,max_height,flight_time"));
+  exportFile = 0;
+  exportOffset = 0;
+  exported = 0;
+}
+
+bool ResultsLog::readNextExportRecord(Record& rec) {
+  // Reopened per record so no file handle is held between passes
+  File f = LittleFS.open(exportFile == 0 ? PREVIOUS_PATH : CURRENT_PATH, "r");
+  if (!f || !f.seek(exportOffset)) return false;
+  
+  // Skip damaged records rather than ending the export
+  bool found = false;
+  while (!found && f.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec)) {
+    found = rec.magic == RECORD_MAGIC && recordCrc(rec) == rec.crc;
+  }
+  exportOffset = f.position();
+  f.close();
+  return found;
+}
+
+void ResultsLog::resetSummary() {
+  count = 0;
+  bestRange = 0;
+  sumRange = 0;
+  sumMaxHeight = 0;
+  sumFlightTime = 0;
+}
+
+void ResultsLog::addToSummary(const Record& rec) {
+  count++;
+  if (rec.range > bestRange) bestRange = rec.range;
+  sumRange += rec.range;
+  sumMaxHeight += rec.maxHeight;
+  sumFlightTime += rec.flightTime;
+}
+
+LogSummary ResultsLog::getSummary() {
+  LogSummary summary;
+  summary.count = count;
+  summary.bestRange = bestRange;
+  summary.avgRange = count ? sumRange / count : 0;
+  summary.avgMaxHeight = count ? sumMaxHeight / count : 0;
+  summary.avgFlightTime = count ? sumFlightTime / count : 0;
+  return summary;
+}
+
+uint16_t ResultsLog::recordCrc(const Record& rec) {
+  const uint8_t* start = (const uint8_t*)&rec.sequence;
+  return crc16(start, sizeof(Record) - (start - (const uint8_t*)&rec));
+}
@@ -0,0 +1,85 @@
+/**
+ * Append-only results log on LittleFS
+ *
+ * Every launch becomes one fixed-size record. Records are buffered in
+ * RAM and written in batches; when the current file reaches
+ * RESULTS_LOG_MAX_RECORDS it becomes the previous file and a new one
+ * starts, so the log never holds more than two files. Summary stats
+ * are kept incrementally and export streams one record at a time, so
+ * nothing proportional to the log size is ever held in RAM.
+ */
+
+#ifndef RESULTS_LOG_H
+#define RESULTS_LOG_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+
+struct LogSummary {
+  unsigned long count;
+  float bestRange;
+  float avgRange;
+  float avgMaxHeight;
+  float avgFlightTime;
+};
+
+class ResultsLog {
+  public:
+    void begin();
+    void append(float height, float gravity, float angle, float velocity, const ShotResult& result);
+    
+    // Timed flushes and export streaming; call every loop() pass
+    void poll(unsigned long now);
+    void flush();
+    
+    void startExport();
+    bool isExporting() { return exportFile >= 0; }
+    
+    LogSummary getSummary();
+    
+  private:
+    struct Record {
+      uint16_t magic;
+      uint16_t crc;  // Over everything after this field
+      uint32_t sequence;
+      float height;
+      float gravity;
+      float angle;
+      float velocity;
+      float range;
+      float maxHeight;
+      float flightTime;
+    };
+    
+    bool mounted;
+    uint32_t nextSequence;
+    uint16_t currentRecords;
+    
+    // Pending batch
+    Record pending[RESULTS_LOG_BATCH];
+    uint8_t pendingCount;
+    unsigned long pendingSince;
+    bool writeFailed;  // Last flush left records behind
+    
+    // Running summary
+    unsigned long count;
+    float bestRange;
+    double sumRange;
+    double sumMaxHeight;
+    double sumFlightTime;
+    
+    // Export cursor: -1 idle, 0 previous file, 1 current file
+    int8_t exportFile;
+    uint32_t exportOffset;
+    unsigned long exported;
+    
+    void scanFile(const char* path, bool current);
+    void resetSummary();
+    void addToSummary(const Record& rec);
+    void rotate(uint8_t unwritten);
+    bool readNextExportRecord(Record& rec);
+    static uint16_t recordCrc(const Record& rec);
+};
+
+#endif
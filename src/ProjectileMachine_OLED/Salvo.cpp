@@ -0,0 +1,166 @@
+/**
+ * Salvo engine implementation
+ */
+
+#include "Salvo.h"
+#include "Obstacles.h"
+#include "Terrain.h"
+#include <math.h>
+
+SalvoEngine salvo;
+
+void SalvoEngine::begin() {
+  mode = (SalvoMode)SALVO_DEFAULT_MODE;
+  forceModel = makeForceModel();
+  count = 0;
+  flying = 0;
+  trailLength = 0;
+}
+
+void SalvoEngine::launch(float height, float gravity, float angle, float velocity) {
+  h0 = height;
+  time = 0;
+  lastStepTime = millis();
+  count = 0;
+  flying = 0;
+  trailHead = 0;
+  trailLength = 0;
+  
+  // Shots are centred on the current setting
+  int half = SALVO_MAX_SHOTS / 2;
+  switch (mode) {
+    case SALVO_ANGLES:
+      for (int i = 0; i < SALVO_MAX_SHOTS; i++) {
+        float a = angle + (i - half) * SALVO_ANGLE_STEP;
+        if (a >= MIN_ANGLE && a <= MAX_ANGLE) addShot(gravity, a, velocity, a);
+      }
+      break;
+    case SALVO_VELOCITIES:
+      for (int i = 0; i < SALVO_MAX_SHOTS; i++) {
+        float v = velocity + (i - half) * SALVO_VELOCITY_STEP;
+        if (v >= MIN_VELOCITY && v <= MAX_VELOCITY) addShot(gravity, angle, v, v);
+      }
+      break;
+    case SALVO_GRAVITIES:
+      addShot(EARTH_GRAVITY, angle, velocity, EARTH_GRAVITY);
+      addShot(MOON_GRAVITY, angle, velocity, MOON_GRAVITY);
+      if (gravity != EARTH_GRAVITY && gravity != MOON_GRAVITY) {
+        addShot(gravity, angle, velocity, gravity);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void SalvoEngine::addShot(float gravity, float angle, float velocity, float param) {
+  if (count >= SALVO_MAX_SHOTS) return;
+  int i = count++;
+  
+  float angleRad = angle * M_PI / 180.0f;
+  vx0[i] = velocity * cos(angleRad);
+  vy0[i] = velocity * sin(angleRad);
+  x[i] = 0;
+  y[i] = h0;
+  vx[i] = vx0[i];
+  vy[i] = vy0[i];
+  g[i] = gravity;
+  landed[i] = false;
+  parameter[i] = param;
+  
+  // Vacuum results are exact from the start
+  TerrainHit hit = terrain.intersect(0, h0, vx0[i], vy0[i], gravity);
+  landTime[i] = hit.t;
+  result[i].range = hit.x;
+  result[i].maxHeight = vy0[i] > 0 ? h0 + vy0[i] * vy0[i] / (2.0f * gravity) : h0;
+  result[i].flightTime = hit.t;
+  
+  // The first obstacle in the way ends the lane; targets are flown through
+  ObstacleHit blocked;
+  if (ActiveForceModel::closedForm &&
+      obstacles.sweep(0, h0, vx0[i], vy0[i], 0, -gravity, hit.t, obstacles.getTargetMask(), blocked)) {
+    landTime[i] = blocked.t;
+    result[i].range = blocked.x;
+    result[i].flightTime = blocked.t;
+    if (vy0[i] - gravity * blocked.t > 0) result[i].maxHeight = blocked.y;
+  }
+  if (!ActiveForceModel::closedForm) {
+    // Drag models fill these in as the lane flies
+    result[i].maxHeight = h0;
+  }
+  
+  for (int p = 0; p < SALVO_TRAIL_POINTS; p++) {
+    trailX[i][p] = 0;
+    trailY[i][p] = h0;
+  }
+  flying++;
+}
+
+int SalvoEngine::update(unsigned long currentMillis) {
+  int steps = 0;
+  while (flying > 0 && currentMillis - lastStepTime >= PHYSICS_STEP_MS) {
+    if (steps == PHYSICS_MAX_CATCHUP) {
+      lastStepTime = currentMillis;
+      break;
+    }
+    step();
+    lastStepTime += PHYSICS_STEP_MS;
+    steps++;
+  }
+  return steps;
+}
+
+void SalvoEngine::step() {
+  time += SIMULATION_DT;
+  
+  if (ActiveForceModel::closedForm) {
+    // One pass over the lanes; each lane stops at its own landing time
+    for (int i = 0; i < count; i++) {
+      float t = min(time, landTime[i]);
+      x[i] = vx0[i] * t;
+      y[i] = h0 + vy0[i] * t - 0.5f * g[i] * t * t;
+      vy[i] = vy0[i] - g[i] * t;
+    }
+    flying = 0;
+    for (int i = 0; i < count; i++) {
+      landed[i] = time >= landTime[i];
+      flying += !landed[i];
+    }
+  } else {
+    stepNumeric();
+  }
+  
+  // Trails share one ring position across lanes
+  for (int i = 0; i < count; i++) {
+    trailX[i][trailHead] = x[i];
+    trailY[i][trailHead] = y[i];
+  }
+  trailHead = (trailHead + 1) % SALVO_TRAIL_POINTS;
+  trailLength = min(trailLength + 1, SALVO_TRAIL_POINTS);
+}
+
+void SalvoEngine::stepNumeric() {
+  for (int i = 0; i < count; i++) {
+    if (landed[i]) continue;
+    
+    // Lanes land on the ground, a cliff face or an obstacle alike
+    BodyState s = {x[i], y[i], vx[i], vy[i]};
+    uint32_t skip = obstacles.getTargetMask();
+    StepContact contact = PhysicsEngine::stepWithContact(s, SIMULATION_DT, g[i], forceModel, skip);
+    if (contact.kind != CONTACT_NONE) {
+      landed[i] = true;
+      flying--;
+      result[i].range = s.x;
+      result[i].flightTime = time - SIMULATION_DT + contact.t;
+    }
+    
+    if (s.y > result[i].maxHeight) {
+      result[i].maxHeight = s.y;
+    }
+    
+    x[i] = s.x;
+    y[i] = s.y;
+    vx[i] = s.vx;
+    vy[i] = s.vy;
+  }
+}
@@ -0,0 +1,94 @@
+/**
+ * Multi-projectile salvo engine
+ *
+ * Advances up to SALVO_MAX_SHOTS projectiles together from a fixed
+ * pool. State is kept as parallel arrays (structure of arrays), so each
+ * step is one loop over the x/y/vx/vy lanes. A salvo spreads the current
+ * shot over angles, velocities or the three gravity presets. Under the
+ * vacuum model every landing is solved against the terrain at launch;
+ * drag models integrate each lane and watch its ground clearance.
+ * Salvo shots do not bounce, and the first obstacle in a lane's path
+ * ends it as it would a single flight.
+ */
+
+#ifndef SALVO_H
+#define SALVO_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+
+enum SalvoMode {
+  SALVO_ANGLES,
+  SALVO_VELOCITIES,
+  SALVO_GRAVITIES,
+  SALVO_MODES
+};
+
+class SalvoEngine {
+  public:
+    void begin();
+    
+    void setMode(SalvoMode mode) { this->mode = mode; }
+    SalvoMode getMode() { return mode; }
+    
+    // Fan the shot out according to the mode and start the flight
+    void launch(float height, float gravity, float angle, float velocity);
+    
+    // Fixed steps against wall time, as in PhysicsEngine
+    int update(unsigned long currentMillis);
+    bool isComplete() { return flying == 0; }
+    
+    int getCount() { return count; }
+    bool isLanded(int i) { return landed[i]; }
+    float getX(int i) { return x[i]; }
+    float getY(int i) { return y[i]; }
+    
+    // Short per-shot trails, oldest first from trailHead
+    float getTrailX(int i, int p) { return trailX[i][(trailHead + p) % SALVO_TRAIL_POINTS]; }
+    float getTrailY(int i, int p) { return trailY[i][(trailHead + p) % SALVO_TRAIL_POINTS]; }
+    int getTrailLength() { return trailLength; }
+    
+    // Per-shot launch value (angle, velocity or gravity) and results
+    float getParameter(int i) { return parameter[i]; }
+    ShotResult getResult(int i) { return result[i]; }
+    
+  private:
+    SalvoMode mode;
+    int count;
+    int flying;
+    float h0;
+    float time;
+    unsigned long lastStepTime;
+    ActiveForceModel forceModel;
+    
+    // Lanes
+    float x[SALVO_MAX_SHOTS];
+    float y[SALVO_MAX_SHOTS];
+    float vx[SALVO_MAX_SHOTS];
+    float vy[SALVO_MAX_SHOTS];
+    float g[SALVO_MAX_SHOTS];
+    float landTime[SALVO_MAX_SHOTS];
+    bool landed[SALVO_MAX_SHOTS];
+    
+    // Launch velocities, for the closed form
+    float vx0[SALVO_MAX_SHOTS];
+    float vy0[SALVO_MAX_SHOTS];
+    
+    float parameter[SALVO_MAX_SHOTS];
+    ShotResult result[SALVO_MAX_SHOTS];
+    
+    // Trails
+    float trailX[SALVO_MAX_SHOTS][SALVO_TRAIL_POINTS];
+    float trailY[SALVO_MAX_SHOTS][SALVO_TRAIL_POINTS];
+    int trailHead;
+    int trailLength;
+    
+    void addShot(float gravity, float angle, float velocity, float param);
+    void step();
+    void stepNumeric();
+};
+
+extern SalvoEngine salvo;
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * Settings journal implementation
+ */
+
+#include "Settings.h"
+#include "Crc.h"
+#include <LittleFS.h>
+
+static const uint16_t RECORD_MAGIC = 0x5350; // "PS"
+static const char* JOURNAL_PATH = "/settings.jnl";
+static const char* COMPACT_PATH = "/settings.tmp";
+
+bool SettingsStore::begin() {
+  for (int i = 0; i <= PRESET_SLOTS; i++) {
+    valid[i] = false;
+  }
+  nextSequence = 1;
+  journalRecords = 0;
+  
+  mounted = LittleFS.begin();
+  if (!mounted) {
+    Serial.println(F("LittleFS mount failed, settings not persisted"));
+    return false;
+  }
+  
+  // A compaction interrupted after writing the copy leaves only the copy
+  if (!LittleFS.exists(JOURNAL_PATH) && LittleFS.exists(COMPACT_PATH)) {
+    LittleFS.rename(COMPACT_PATH, JOURNAL_PATH);
+  }
+  
+  replay();
+  return true;
+}
+
+void SettingsStore::replay() {
+  File f = LittleFS.open(JOURNAL_PATH, "r");
+  if (!f) return;
+  
+  Record rec;
+  while (f.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec)) {
+    journalRecords++;
+    if (rec.magic != RECORD_MAGIC || rec.slot > PRESET_SLOTS) continue;
+    if (crc16((const uint8_t*)&rec, sizeof(rec) - sizeof(rec.crc)) != rec.crc) continue;
+    
+    if (!valid[rec.slot] || rec.sequence > slots[rec.slot].sequence) {
+      slots[rec.slot] = rec;
+      valid[rec.slot] = true;
+    }
+    if (rec.sequence >= nextSequence) {
+      nextSequence = rec.sequence + 1;
+    }
+  }
+  f.close();
+}
+
+bool SettingsStore::load(uint8_t slot, LaunchSettings& out) {
+  if (!isValid(slot)) return false;
+  out = slots[slot].settings;
+  return true;
+}
+
+bool SettingsStore::save(uint8_t slot, const LaunchSettings& settings, const char* name) {
+  if (!mounted || slot > PRESET_SLOTS) return false;
+  
+  // Skip the flash write when nothing changed
+  if (valid[slot] && memcmp(&slots[slot].settings, &settings, sizeof(settings)) == 0 &&
+      strncmp(slots[slot].name, name, PRESET_NAME_LENGTH) == 0) {
+    return true;
+  }
+  
+  if (journalRecords >= SETTINGS_JOURNAL_MAX) {
+    compact();
+  }
+  
+  Record rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.magic = RECORD_MAGIC;
+  rec.slot = slot;
+  rec.sequence = nextSequence++;
+  rec.settings = settings;
+  strncpy(rec.name, name, PRESET_NAME_LENGTH - 1);
+  rec.crc = crc16((const uint8_t*)&rec, sizeof(rec) - sizeof(rec.crc));
+  
+  File f = LittleFS.open(JOURNAL_PATH, "a");
+  if (!f) return false;
+  bool ok = f.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+  f.close();
+  if (!ok) return false;
+  
+  journalRecords++;
+  slots[slot] = rec;
+  valid[slot] = true;
+  return true;
+}
+
+void SettingsStore::compact() {
+  File f = LittleFS.open(COMPACT_PATH, "w");
+  if (!f) return;
+  
+  uint16_t written = 0;
+  for (int i = 0; i <= PRESET_SLOTS; i++) {
+    if (valid[i]) {
+      f.write((const uint8_t*)&slots[i], sizeof(Record));
+      written++;
+    }
+  }
+  f.close();
+  
+  LittleFS.remove(JOURNAL_PATH);
+  LittleFS.rename(COMPACT_PATH, JOURNAL_PATH);
+  journalRecords = written;
+}
+
+const char* SettingsStore::getName(uint8_t slot) {
+  return isValid(slot) ? slots[slot].name : "";
+}
+
+void SettingsStore::list(Print& out) {
+  for (int i = 0; i <= PRESET_SLOTS; i++) {
+    if (!valid[i]) continue;
+    
+    const LaunchSettings& s = slots[i].settings;
+    out.print(i == SESSION_SLOT ? F("session") : F("preset "));
+    if (i != SESSION_SLOT) out.print(i);
+    out.print(' ');
+    out.print(slots[i].name);
+    out.print(F(" h="));
+    out.print(s.height, 1);
+    out.print(F(" g="));
+    out.print(s.gravity, 2);
+    out.print(F(" a="));
+    out.print(s.angle, 1);
+    out.print(F(" v="));
+    out.println(s.velocity, 1);
+  }
+  out.print(F("journal "));
+  out.print(journalRecords);
+  out.print('/');
+  out.println(SETTINGS_JOURNAL_MAX);
+}
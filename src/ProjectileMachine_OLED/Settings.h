@@ -0,0 +1,60 @@
+/**
+ * Persistent launch settings and named presets on LittleFS
+ *
+ * Records are fixed-size and only ever appended to a journal file;
+ * the newest valid record for each slot wins when the journal is
+ * replayed at boot. A torn write at the tail fails its CRC and is
+ * ignored. When the journal fills up, the live records are copied to
+ * a fresh file that replaces it, so flash is rewritten once per
+ * SETTINGS_JOURNAL_MAX saves rather than on every save.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Slot 0 holds the last session; 1..PRESET_SLOTS are named presets
+#define SESSION_SLOT 0
+
+struct LaunchSettings {
+  float height;
+  float gravity;
+  float angle;
+  float velocity;
+};
+
+class SettingsStore {
+  public:
+    bool begin();
+    
+    bool load(uint8_t slot, LaunchSettings& out);
+    bool save(uint8_t slot, const LaunchSettings& settings, const char* name = "");
+    const char* getName(uint8_t slot);
+    bool isValid(uint8_t slot) { return slot <= PRESET_SLOTS && valid[slot]; }
+    
+    void list(Print& out);
+    
+  private:
+    struct Record {
+      uint16_t magic;
+      uint8_t slot;
+      uint8_t reserved;
+      uint32_t sequence;
+      LaunchSettings settings;
+      char name[PRESET_NAME_LENGTH];
+      uint16_t crc;
+    };
+    
+    bool mounted;
+    uint32_t nextSequence;
+    uint16_t journalRecords;
+    Record slots[PRESET_SLOTS + 1];
+    bool valid[PRESET_SLOTS + 1];
+    
+    void replay();
+    void compact();
+};
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * Flight snapshot implementation
+ */
+
+#include "Snapshot.h"
+
+TripleBuffer<FlightSnapshot> flightSnapshots;
+
+void publishFlight(PhysicsEngine& engine) {
+  FlightSnapshot& s = flightSnapshots.writeSlot();
+  s.position = engine.getCurrentPosition();
+  s.velocity = engine.getCurrentVelocity();
+  memcpy(s.trail, engine.getTrail(), sizeof(s.trail));
+  s.trailLength = engine.getTrailLength();
+  memcpy(s.steps, engine.getStepHistory(), sizeof(s.steps));
+  
+  // Camera keeps the ball mid-screen once it has left the cannon
+  s.cameraX = max(s.position.x - SCREEN_WIDTH / 2, 0.0f);
+  s.targetMask = engine.getTargetMask();
+  s.stepCount = engine.getStepCount();
+  s.complete = engine.isSimulationComplete();
+  flightSnapshots.publish();
+}
@@ -0,0 +1,105 @@
+/**
+ * Flight snapshots handed from the simulation to the renderer
+ *
+ * The physics side fills a FlightSnapshot and publishes it; the render
+ * side acquires the newest one. Three slots rotate through one shared
+ * index: the producer owns one, the consumer owns one, and the third
+ * holds the latest publication. Publish and acquire are each a single
+ * atomic exchange, so neither side ever waits for the other and no
+ * slot is written while it is being read. Physics can then run from a
+ * timer tick (PHYSICS_TICKER) or another thread while frames draw.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+
+struct FlightSnapshot {
+  Point position;
+  Point velocity;
+  TrailPoint trail[BUILD.trailPoints];
+  int trailLength;
+  float cameraX;        // World x at the view's left edge
+  uint32_t targetMask;  // Targets hit so far
+  uint32_t stepCount;   // Physics steps since launch
+  bool complete;
+  
+  // Steps taken between two acquires are all still here, as long as the
+  // reader is no more than BUILD.stepHistory behind
+  StepRecord steps[BUILD.stepHistory];
+  
+  // Step n (from 1), or NULL once it has left the history
+  const StepRecord* step(uint32_t n) const {
+    if (n == 0 || n > stepCount || stepCount - n >= (uint32_t)BUILD.stepHistory) return NULL;
+    return &steps[n % BUILD.stepHistory];
+  }
+};
+
+static_assert(BUILD.stepHistory >= PHYSICS_MAX_CATCHUP, "A loop update() must fit in the step history");
+
+// Swap of the shared slot index. The ESP8266 has no atomic
+// instructions, so interrupts are masked around the swap instead
+inline uint8_t exchangeSlot(volatile uint8_t* shared, uint8_t value) {
+#if defined(ESP8266)
+  uint32_t saved = xt_rsil(15);
+  uint8_t old = *shared;
+  *shared = value;
+  xt_wsr_ps(saved);
+  return old;
+#else
+  return __atomic_exchange_n(shared, value, __ATOMIC_ACQ_REL);
+#endif
+}
+
+inline uint8_t loadSlot(volatile uint8_t* shared) {
+#if defined(ESP8266)
+  return *shared;
+#else
+  return __atomic_load_n(shared, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// Single producer, single consumer
+template <typename T>
+class TripleBuffer {
+  public:
+    void begin() {
+      producer = 0;
+      shared = 1;
+      consumer = 2;
+    }
+    
+    // Slot for the producer to fill
+    T& writeSlot() { return slots[producer]; }
+    
+    // Hands the filled slot over, replacing one the consumer never took
+    void publish() { producer = exchangeSlot(&shared, producer | FRESH) & INDEX; }
+    
+    // Newest published slot, or the last one again if nothing is new;
+    // it stays untouched until the consumer's next acquire
+    const T& acquire() {
+      if (loadSlot(&shared) & FRESH) {
+        consumer = exchangeSlot(&shared, consumer) & INDEX;
+      }
+      return slots[consumer];
+    }
+    
+  private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x04;  // Set by publish, cleared by acquire
+    
+    T slots[3];
+    uint8_t producer;
+    uint8_t consumer;
+    volatile uint8_t shared;
+};
+
+// Copies the engine's state into the next slot and publishes it
+void publishFlight(PhysicsEngine& engine);
+
+extern TripleBuffer<FlightSnapshot> flightSnapshots;
+
+#endif
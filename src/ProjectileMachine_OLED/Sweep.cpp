@@ -0,0 +1,111 @@
+/**
+ * Parameter sweep implementation
+ */
+
+#include "Sweep.h"
+#include "Obstacles.h"
+#include "Physics.h"
+#include "Terrain.h"
+#include <math.h>
+
+SweepMap sweep;
+
+// Integration steps between clock checks, and the longest flight followed
+static const int STEPS_PER_CHECK = 16;
+static const float MAX_FLIGHT_TIME = 120.0f;
+
+void SweepMap::begin() {
+  metric = SWEEP_RANGE;
+  forceModel = makeForceModel();
+  h0 = g = -1;
+  done = 0;
+  flying = false;
+}
+
+void SweepMap::setLaunch(float h0, float g) {
+  if (h0 == this->h0 && g == this->g) return;
+  this->h0 = h0;
+  this->g = g;
+  done = 0;
+  flying = false;
+  for (int m = 0; m < SWEEP_METRICS; m++) {
+    maxValue[m] = 1;
+  }
+}
+
+float SweepMap::columnAngle(int column) {
+  return MIN_ANGLE + (column + 0.5f) * (MAX_ANGLE - MIN_ANGLE) / SWEEP_ANGLE_CELLS;
+}
+
+float SweepMap::rowVelocity(int row) {
+  return MIN_VELOCITY + (row + 0.5f) * (MAX_VELOCITY - MIN_VELOCITY) / SWEEP_VELOCITY_CELLS;
+}
+
+bool SweepMap::update(unsigned long sliceMicros) {
+  unsigned long start = micros();
+  while (done < SWEEP_CELLS) {
+    if (ActiveForceModel::closedForm) {
+      evaluateVacuum();
+    } else if (!stepNumeric(start, sliceMicros)) {
+      break;
+    }
+    if (micros() - start >= sliceMicros) break;
+  }
+  return isComplete();
+}
+
+void SweepMap::evaluateVacuum() {
+  float angleRad = columnAngle(done % SWEEP_ANGLE_CELLS) * M_PI / 180.0f;
+  float velocity = rowVelocity(done / SWEEP_ANGLE_CELLS);
+  float vx = velocity * cos(angleRad);
+  float vy = velocity * sin(angleRad);
+  
+  TerrainHit hit = terrain.intersect(0, h0, vx, vy, g);
+  float apex = vy > 0 ? h0 + vy * vy / (2.0f * g) : h0;
+  
+  // The first obstacle in the way ends the flight; targets are flown through
+  ObstacleHit blocked;
+  if (obstacles.sweep(0, h0, vx, vy, 0, -g, hit.t, obstacles.getTargetMask(), blocked)) {
+    if (vy - g * blocked.t > 0) apex = blocked.y;
+    store(blocked.x, apex, blocked.t);
+    return;
+  }
+  store(hit.x, apex, hit.t);
+}
+
+bool SweepMap::stepNumeric(unsigned long start, unsigned long sliceMicros) {
+  if (!flying) {
+    float angleRad = columnAngle(done % SWEEP_ANGLE_CELLS) * M_PI / 180.0f;
+    float velocity = rowVelocity(done / SWEEP_ANGLE_CELLS);
+    body = {0, h0, velocity * cos(angleRad), velocity * sin(angleRad)};
+    bodyTime = 0;
+    bodyApex = h0;
+    flying = true;
+  }
+  
+  while (micros() - start < sliceMicros) {
+    for (int i = 0; i < STEPS_PER_CHECK; i++) {
+      uint32_t skip = obstacles.getTargetMask();
+      StepContact contact = PhysicsEngine::stepWithContact(body, SIMULATION_DT, g, forceModel, skip);
+      bodyTime += SIMULATION_DT;
+      bodyApex = max(bodyApex, body.y);
+      
+      if (contact.kind != CONTACT_NONE || bodyTime >= MAX_FLIGHT_TIME) {
+        store(body.x, bodyApex, bodyTime - SIMULATION_DT + contact.t);
+        flying = false;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void SweepMap::store(float range, float apex, float time) {
+  float metrics[SWEEP_METRICS] = {range, apex, time};
+  for (int m = 0; m < SWEEP_METRICS; m++) {
+    uint16_t value = constrain(metrics[m] * SWEEP_SCALE, 0.0f, 65535.0f);
+    values[m][done] = value;
+    maxValue[m] = max(maxValue[m], value);
+  }
+  done++;
+}
@@ -0,0 +1,75 @@
+/**
+ * Angle x velocity parameter sweep
+ *
+ * Evaluates range, apex and flight time over a grid of launch angles
+ * and velocities at the current height and gravity. The grid is filled
+ * a few cells per call within a time slice, so the heatmap builds up
+ * over several frames without stalling the loop. Cells are kept until
+ * the height or gravity changes. Under drag a single flight can outlast
+ * the slice, so the cell being integrated carries over to the next call.
+ * A cell whose flight meets an obstacle ends at the contact point.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "ForceModels.h"
+
+#define SWEEP_CELLS (SWEEP_ANGLE_CELLS * SWEEP_VELOCITY_CELLS)
+
+enum SweepMetric {
+  SWEEP_RANGE,
+  SWEEP_APEX,
+  SWEEP_TIME,
+  SWEEP_METRICS
+};
+
+class SweepMap {
+  public:
+    void begin();
+    
+    // Keeps the cached grid unless the height or gravity changed
+    void setLaunch(float h0, float g);
+    
+    // Evaluate cells for up to sliceMicros; true once the grid is complete
+    bool update(unsigned long sliceMicros);
+    bool isComplete() { return done == SWEEP_CELLS; }
+    int getDone() { return done; }
+    
+    SweepMetric getMetric() { return metric; }
+    void nextMetric() { metric = (SweepMetric)((metric + 1) % SWEEP_METRICS); }
+    
+    // Completed cells in 1/SWEEP_SCALE units of the metric; row 0 is the slowest
+    bool isDone(int column, int row) { return row * SWEEP_ANGLE_CELLS + column < done; }
+    uint16_t getValue(int column, int row) { return values[metric][row * SWEEP_ANGLE_CELLS + column]; }
+    uint16_t getMaxValue() { return maxValue[metric]; }
+    
+    static float columnAngle(int column);
+    static float rowVelocity(int row);
+    
+  private:
+    float h0;
+    float g;
+    ActiveForceModel forceModel;
+    SweepMetric metric;
+    int done;
+    
+    uint16_t values[SWEEP_METRICS][SWEEP_CELLS];
+    uint16_t maxValue[SWEEP_METRICS];
+    
+    // Numeric flight of cell 'done', resumed across slices
+    bool flying;
+    BodyState body;
+    float bodyTime;
+    float bodyApex;
+    
+    void evaluateVacuum();
+    bool stepNumeric(unsigned long start, unsigned long sliceMicros);
+    void store(float range, float apex, float time);
+};
+
+extern SweepMap sweep;
+
+#endif
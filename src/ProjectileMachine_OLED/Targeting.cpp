@@ -0,0 +1,119 @@
+/**
+ * Targeting solver implementation
+ */
+
+#include "Targeting.h"
+#include "Terrain.h"
+#include <math.h>
+
+Targeting targeting;
+
+void Targeting::begin() {
+  distance = 40.0f;
+  height = 0;
+  choice = TARGET_LOW;
+  forceModel = makeForceModel();
+  lowPath.begin();
+  highPath.begin();
+}
+
+void Targeting::setTarget(float distance, float height) {
+  this->distance = constrain(distance, TARGET_MIN_DISTANCE, TARGET_MAX_DISTANCE);
+  this->height = height;
+}
+
+TargetSolution Targeting::solveVacuum(float h0, float g, float velocity, float distance, float height) {
+  TargetSolution s;
+  float dy = height - h0;
+  
+  // Slowest shot: v² = g·(dy + √(dy² + x²)), aimed at tanθ = v²/(g·x)
+  float hyp = sqrt(dy * dy + distance * distance);
+  s.minVelocity = sqrt(g * (dy + hyp));
+  s.minVelocityAngle = atan2(dy + hyp, distance) * 180.0f / M_PI;
+  
+  // a·u² - x·u + (a + dy) = 0 with u = tanθ, a = g·x² / (2v²)
+  float a = g * distance * distance / (2.0f * velocity * velocity);
+  float discriminant = distance * distance - 4.0f * a * (a + dy);
+  s.reachable = discriminant >= 0;
+  if (!s.reachable) {
+    s.lowAngle = s.highAngle = s.minVelocityAngle;
+    return s;
+  }
+  
+  float root = sqrt(discriminant);
+  s.lowAngle = atan((distance - root) / (2.0f * a)) * 180.0f / M_PI;
+  s.highAngle = atan((distance + root) / (2.0f * a)) * 180.0f / M_PI;
+  
+  // Downward shots are outside the cannon's range of motion
+  if (s.lowAngle < MIN_ANGLE) s.lowAngle = s.highAngle;
+  s.reachable = s.highAngle >= MIN_ANGLE && s.highAngle <= MAX_ANGLE;
+  return s;
+}
+
+void Targeting::update(float h0, float g, float velocity) {
+  solution = solveVacuum(h0, g, velocity, distance, height);
+  
+  if (!ActiveForceModel::closedForm) {
+    // A tailwind or Magnus lift can carry a shot past vacuum reach, so a
+    // target the vacuum cannot hit is still tried on the integrated
+    // flight, from the vacuum's best angle
+    if (!solution.reachable) {
+      solution.lowAngle = solution.highAngle = constrain(solution.minVelocityAngle, MIN_ANGLE, MAX_ANGLE);
+    }
+    solution.lowAngle = polishAngle(h0, g, velocity, solution.lowAngle);
+    solution.highAngle = polishAngle(h0, g, velocity, solution.highAngle);
+    solution.reachable = fabs(heightAtTarget(h0, g, velocity, solution.highAngle) - height) < TARGET_TOLERANCE;
+  }
+  
+  float low = solution.reachable ? solution.lowAngle : solution.minVelocityAngle;
+  float high = solution.reachable ? solution.highAngle : solution.minVelocityAngle;
+  float v = solution.reachable ? velocity : min(solution.minVelocity, MAX_VELOCITY);
+  lowPath.setParameters(h0, g, low, v);
+  highPath.setParameters(h0, g, high, v);
+}
+
+bool Targeting::getChoiceLaunch(float velocity, float& angle, float& launchVelocity) {
+  launchVelocity = velocity;
+  switch (choice) {
+    case TARGET_LOW:
+      angle = solution.lowAngle;
+      return solution.reachable;
+    case TARGET_HIGH:
+      angle = solution.highAngle;
+      return solution.reachable;
+    default:
+      angle = solution.minVelocityAngle;
+      launchVelocity = solution.minVelocity;
+      return launchVelocity <= MAX_VELOCITY && angle >= MIN_ANGLE && angle <= MAX_ANGLE;
+  }
+}
+
+float Targeting::polishAngle(float h0, float g, float velocity, float angle) {
+  // Newton on the height at the target distance, secant derivative
+  const float delta = 0.25f;
+  for (int i = 0; i < TARGET_NEWTON_STEPS; i++) {
+    float error = heightAtTarget(h0, g, velocity, angle) - height;
+    float slope = (heightAtTarget(h0, g, velocity, angle + delta) - height - error) / delta;
+    if (fabs(slope) < 1e-4f) break;
+    angle = constrain(angle - error / slope, MIN_ANGLE, MAX_ANGLE);
+    if (fabs(error) < 0.01f) break;
+  }
+  return angle;
+}
+
+float Targeting::heightAtTarget(float h0, float g, float velocity, float angle) {
+  float angleRad = angle * M_PI / 180.0f;
+  BodyState s = {0, h0, velocity * cos(angleRad), velocity * sin(angleRad)};
+  
+  // Fly until the target's x is passed, or the shot comes down short
+  for (int i = 0; i < 2000; i++) {
+    BodyState prev = s;
+    advance<ActiveIntegrator>(s, SIMULATION_DT, g, forceModel);
+    if (s.x >= distance) {
+      float f = (distance - prev.x) / (s.x - prev.x);
+      return prev.y + (s.y - prev.y) * f;
+    }
+    if (s.vy < 0 && s.y < height - 100.0f) break;
+  }
+  return height - 100.0f;
+}
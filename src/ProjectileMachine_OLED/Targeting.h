@@ -0,0 +1,73 @@
+/**
+ * Targeting solver: launch angles and minimum velocity for a target
+ *
+ * For a target at (distance, height), the vacuum launch equation
+ * y = x·tanθ - g·x²·(1 + tan²θ) / (2v²) is a quadratic in tanθ, so both
+ * angles and the minimum velocity come out in closed form, launch
+ * height included. Drag models have no closed form; the vacuum angles
+ * seed a few Newton steps on the integrated flight instead, or the
+ * vacuum's best angle when the target is out of vacuum reach, since
+ * wind and Magnus lift can reach further. The minimum velocity is
+ * always the vacuum figure.
+ */
+
+#ifndef TARGETING_H
+#define TARGETING_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+
+enum TargetChoice {
+  TARGET_LOW,
+  TARGET_HIGH,
+  TARGET_MIN_VELOCITY,
+  TARGET_CHOICES
+};
+
+struct TargetSolution {
+  bool reachable;         // At the current velocity
+  float lowAngle;         // Degrees, valid when reachable
+  float highAngle;
+  float minVelocity;      // Slowest vacuum shot that gets there at all
+  float minVelocityAngle;
+};
+
+class Targeting {
+  public:
+    void begin();
+    
+    void setTarget(float distance, float height);
+    float getDistance() { return distance; }
+    float getHeight() { return height; }
+    
+    // Re-solve for the launch and refresh both predicted paths
+    void update(float h0, float g, float velocity);
+    TargetSolution getSolution() { return solution; }
+    
+    TargetChoice getChoice() { return choice; }
+    void nextChoice() { choice = (TargetChoice)((choice + 1) % TARGET_CHOICES); }
+    
+    // Angle and velocity of the chosen solution; false if not reachable
+    bool getChoiceLaunch(float velocity, float& angle, float& launchVelocity);
+    
+    // Predicted paths of the low and high solutions
+    PhysicsEngine lowPath;
+    PhysicsEngine highPath;
+    
+    static TargetSolution solveVacuum(float h0, float g, float velocity, float distance, float height);
+    
+  private:
+    float distance;
+    float height;
+    TargetChoice choice;
+    TargetSolution solution;
+    ActiveForceModel forceModel;
+    
+    float polishAngle(float h0, float g, float velocity, float angle);
+    float heightAtTarget(float h0, float g, float velocity, float angle);
+};
+
+extern Targeting targeting;
+
+#endif
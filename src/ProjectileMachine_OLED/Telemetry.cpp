@@ -0,0 +1,136 @@
+/**
+ * Binary telemetry implementation
+ */
+
+#include "Telemetry.h"
+#include "Crc.h"
+
+void Telemetry::begin() {
+  enabled = TELEMETRY_DEFAULT_ON;
+  sequence = 0;
+  droppedFrames = 0;
+  head = 0;
+  tail = 0;
+  payloadLength = 0;
+}
+
+void Telemetry::sendTick(uint32_t tick, Point pos, Point vel, uint8_t state, unsigned long frameMicros) {
+  if (!enabled) return;
+  
+  beginRecord(TELEM_TICK);
+  putU32(tick);
+  putFloat(pos.x);
+  putFloat(pos.y);
+  putFloat(vel.x);
+  putFloat(vel.y);
+  putU8(state);
+  putU16(frameMicros > 0xFFFF ? 0xFFFF : frameMicros);
+  endRecord();
+}
+
+void Telemetry::sendLaunch(float height, float gravity, float angle, float velocity) {
+  if (!enabled) return;
+  
+  beginRecord(TELEM_LAUNCH);
+  putFloat(height);
+  putFloat(gravity);
+  putFloat(angle);
+  putFloat(velocity);
+  endRecord();
+}
+
+void Telemetry::sendResult(float range, float maxHeight, float time) {
+  if (!enabled) return;
+  
+  beginRecord(TELEM_RESULT);
+  putFloat(range);
+  putFloat(maxHeight);
+  putFloat(time);
+  endRecord();
+}
+
+void Telemetry::pump() {
+  if (head == tail) return;
+  
+  int room = Serial.availableForWrite();
+  while (room > 0 && head != tail) {
+    // Largest contiguous run before the ring wraps
+    uint16_t run = head > tail ? head - tail : TELEMETRY_RING_SIZE - tail;
+    if (run > room) run = room;
+    
+    Serial.write(ring + tail, run);
+    tail = (tail + run) % TELEMETRY_RING_SIZE;
+    room -= run;
+  }
+}
+
+void Telemetry::beginRecord(uint8_t type) {
+  payloadLength = 0;
+  putU8(type);
+  putU8(sequence++);
+}
+
+void Telemetry::putU8(uint8_t value) {
+  if (payloadLength < TELEMETRY_MAX_PAYLOAD) {
+    payload[payloadLength++] = value;
+  }
+}
+
+void Telemetry::putU16(uint16_t value) {
+  putU8(value & 0xFF);
+  putU8(value >> 8);
+}
+
+void Telemetry::putU32(uint32_t value) {
+  putU16(value & 0xFFFF);
+  putU16(value >> 16);
+}
+
+void Telemetry::putFloat(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  putU32(bits);
+}
+
+void Telemetry::endRecord() {
+  uint16_t crc = crc16(payload, payloadLength);
+  putU16(crc);
+  
+  // Leading and trailing delimiters plus one COBS overhead byte
+  // (payloads stay under 254 bytes)
+  if (ringFree() < payloadLength + 3) {
+    droppedFrames++;
+    return;
+  }
+  
+  // Leading delimiter resyncs the decoder after any text on the port
+  ring[head] = 0;
+  head = (head + 1) % TELEMETRY_RING_SIZE;
+  
+  // COBS: each code byte counts the bytes up to the next zero
+  uint16_t codeIndex = head;
+  uint8_t code = 1;
+  head = (head + 1) % TELEMETRY_RING_SIZE;
+  
+  for (uint8_t i = 0; i < payloadLength; i++) {
+    if (payload[i] == 0) {
+      ring[codeIndex] = code;
+      codeIndex = head;
+      code = 1;
+    } else {
+      ring[head] = payload[i];
+      code++;
+    }
+    head = (head + 1) % TELEMETRY_RING_SIZE;
+  }
+  ring[codeIndex] = code;
+  
+  // Frame delimiter
+  ring[head] = 0;
+  head = (head + 1) % TELEMETRY_RING_SIZE;
+}
+
+uint16_t Telemetry::ringFree() {
+  // One slot stays empty to tell full from empty
+  return (tail + TELEMETRY_RING_SIZE - head - 1) % TELEMETRY_RING_SIZE;
+}
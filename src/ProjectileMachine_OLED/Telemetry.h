@@ -0,0 +1,64 @@
+/**
+ * Binary telemetry stream over Serial
+ *
+ * Each record is a little-endian payload followed by a CRC-16/CCITT,
+ * COBS-encoded and framed by 0x00 bytes on both sides. Frames are queued in a
+ * TX ring and drained only as fast as the UART accepts them, so
+ * loop() never blocks on Serial. tools/telemetry_decode.py is the
+ * host-side decoder.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Physics.h"
+
+enum TelemetryRecord {
+  TELEM_TICK = 1,    // u32 tick, f32 x, y, vx, vy, u8 state, u16 frame_us
+  TELEM_LAUNCH = 2,  // f32 h0, g, angle_deg, v0
+  TELEM_RESULT = 3   // f32 range, max_height, flight_time
+};
+
+class Telemetry {
+  public:
+    void begin();
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() { return enabled; }
+    
+    void sendTick(uint32_t tick, Point pos, Point vel, uint8_t state, unsigned long frameMicros);
+    void sendLaunch(float height, float gravity, float angle, float velocity);
+    void sendResult(float range, float maxHeight, float time);
+    
+    // Move queued bytes into the UART without blocking
+    void pump();
+    bool isDrained() { return head == tail; }
+    
+    unsigned long getDroppedFrames() { return droppedFrames; }
+    
+  private:
+    bool enabled;
+    uint8_t sequence;
+    unsigned long droppedFrames;
+    
+    // TX ring
+    uint8_t ring[TELEMETRY_RING_SIZE];
+    uint16_t head;
+    uint16_t tail;
+    
+    // Payload under construction
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    uint8_t payloadLength;
+    
+    void beginRecord(uint8_t type);
+    void putU8(uint8_t value);
+    void putU16(uint16_t value);
+    void putU32(uint32_t value);
+    void putFloat(float value);
+    void endRecord();
+    
+    uint16_t ringFree();
+};
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ * Terrain profile implementation
+ */
+
+#include "Terrain.h"
+#include <math.h>
+
+Terrain terrain;
+
+// Launch pad, a hill, a drop into a valley, a raised target platform,
+// then a ramp up to the plateau that runs on forever
+static const TerrainVertex PROFILE[] = {
+  {0, 0}, {400, 0}, {550, 80}, {700, 0}, {900, 0},
+  {900, -50}, {1200, -50}, {1500, -50}, {1500, 100}, {1650, 100},
+  {1650, -50}, {2000, -50}, {2200, 40}
+};
+
+static const TerrainVertex FLAT[] = {{0, 0}};
+
+// Contact closer than this to the start of an arc is the launch point itself
+static const float MIN_CONTACT = 1e-3f;
+
+void Terrain::begin() {
+  if (TERRAIN_ENABLED) {
+    vertices = PROFILE;
+    vertexCount = sizeof(PROFILE) / sizeof(PROFILE[0]);
+  } else {
+    vertices = FLAT;
+    vertexCount = 1;
+  }
+  
+  float length = vertices[vertexCount - 1].x * 0.1f;
+  bucketCount = min((int)(length / TERRAIN_BUCKET_M) + 1, TERRAIN_MAX_BUCKETS);
+  
+  // Segment i runs from vertex i to i + 1
+  int segment = 0;
+  for (int b = 0; b < bucketCount; b++) {
+    float start = b * TERRAIN_BUCKET_M;
+    float end = start + TERRAIN_BUCKET_M;
+    while (segment < vertexCount - 2 && getVertexX(segment + 1) <= start) {
+      segment++;
+    }
+    bucketFirst[b] = segment;
+    
+    bucketMax[b] = getVertexY(segment);
+    for (int i = segment + 1; i < vertexCount && getVertexX(i - 1) < end; i++) {
+      bucketMax[b] = max(bucketMax[b], getVertexY(i));
+    }
+  }
+}
+
+int Terrain::bucketOf(float x) {
+  int b = (int)(x / TERRAIN_BUCKET_M);
+  return constrain(b, 0, bucketCount - 1);
+}
+
+int Terrain::firstVertexAt(float x) {
+  // Last vertex at or left of x
+  int i = bucketFirst[bucketOf(x)];
+  while (i < vertexCount - 1 && getVertexX(i + 1) <= x) {
+    i++;
+  }
+  return i;
+}
+
+float Terrain::heightAt(float x) {
+  int i = firstVertexAt(x);
+  if (i == vertexCount - 1 || x <= getVertexX(0)) {
+    return getVertexY(i);
+  }
+  
+  float xa = getVertexX(i);
+  float xb = getVertexX(i + 1);
+  float ya = getVertexY(i);
+  float yb = getVertexY(i + 1);
+  return ya + (yb - ya) * (x - xa) / (xb - xa);
+}
+
+float Terrain::slopeAt(float x) {
+  int i = firstVertexAt(x);
+  if (i == vertexCount - 1 || x <= getVertexX(0)) {
+    return 0;
+  }
+  return (getVertexY(i + 1) - getVertexY(i)) / (getVertexX(i + 1) - getVertexX(i));
+}
+
+float Terrain::clearDistance(float x, float limit) {
+  for (int i = firstVertexAt(x); i < vertexCount - 1; i++) {
+    float xa = getVertexX(i);
+    if (xa - x >= limit) break;
+    if (xa > x && xa == getVertexX(i + 1) && getVertexY(i + 1) > getVertexY(i)) {
+      return xa - x;
+    }
+  }
+  return limit;
+}
+
+TerrainHit Terrain::intersect(float x0, float y0, float vx, float vy, float g) {
+  TerrainHit hit;
+  
+  if (vx > 1e-4f) {
+    // Walk the buckets the arc passes over; the arc is concave, so it
+    // clears a bucket whenever both ends are above the bucket's top
+    float lastX = getVertexX(vertexCount - 1);
+    for (int b = bucketOf(x0); b < bucketCount && x0 < lastX; b++) {
+      float start = max(b * TERRAIN_BUCKET_M, x0);
+      float end = (b + 1) * TERRAIN_BUCKET_M;
+      float t0 = (start - x0) / vx;
+      float t1 = (end - x0) / vx;
+      if (y0 + vy * t0 - 0.5f * g * t0 * t0 > bucketMax[b] &&
+          y0 + vy * t1 - 0.5f * g * t1 * t1 > bucketMax[b]) {
+        continue;
+      }
+      
+      for (int i = bucketFirst[b]; i < vertexCount - 1 && getVertexX(i) < end; i++) {
+        if (segmentHit(i, x0, y0, vx, vy, g, hit)) {
+          return hit;
+        }
+      }
+    }
+  }
+  
+  // Flat ground under the arc (vertical shots, or past the last vertex)
+  float ground = vx > 1e-4f ? getVertexY(vertexCount - 1) : heightAt(x0);
+  float discriminant = vy * vy + 2.0f * g * (y0 - ground);
+  hit.t = discriminant >= 0 ? (vy + sqrt(discriminant)) / g : 0;
+  hit.x = x0 + vx * hit.t;
+  hit.y = ground;
+  hit.slope = 0;
+  hit.wall = false;
+  return hit;
+}
+
+bool Terrain::segmentHit(int i, float x0, float y0, float vx, float vy, float g, TerrainHit& hit) {
+  float xa = getVertexX(i);
+  float xb = getVertexX(i + 1);
+  float ya = getVertexY(i);
+  float yb = getVertexY(i + 1);
+  if (xb <= x0) return false;
+  
+  if (xa == xb) {
+    // Only the face of a rising cliff can be hit from the left
+    if (yb <= ya || xa - x0 < MIN_CONTACT) return false;
+    float t = (xa - x0) / vx;
+    float y = y0 + vy * t - 0.5f * g * t * t;
+    if (y < ya || y > yb) return false;
+    hit = {t, xa, y, 0, true};
+    return true;
+  }
+  
+  // Parabola minus the segment's line, in u = x - x0:
+  // a·u² + b·u + c = 0
+  float m = (yb - ya) / (xb - xa);
+  float a = -0.5f * g / (vx * vx);
+  float b = vy / vx - m;
+  float c = y0 - (ya + m * (x0 - xa));
+  float discriminant = b * b - 4 * a * c;
+  if (discriminant < 0) return false;
+  
+  float root = sqrt(discriminant);
+  float u1 = (-b + root) / (2 * a);
+  float u2 = (-b - root) / (2 * a);
+  if (u1 > u2) {
+    float swap = u1;
+    u1 = u2;
+    u2 = swap;
+  }
+  
+  float lo = max(xa - x0, MIN_CONTACT);
+  float hi = xb - x0;
+  float u = u1 >= lo && u1 <= hi ? u1 : (u2 >= lo && u2 <= hi ? u2 : -1);
+  if (u < 0) return false;
+  
+  hit = {u / vx, x0 + u, ya + m * (x0 + u - xa), m, false};
+  return true;
+}
@@ -0,0 +1,65 @@
+/**
+ * Piecewise-linear terrain profile
+ *
+ * Vertices are stored in decimetres, ordered by x; two vertices with the
+ * same x make a vertical cliff. Past the last vertex the ground stays
+ * flat at its height. A coarse x-bucket index records the first segment
+ * and the highest point in each bucket, so a trajectory only tests the
+ * segments of buckets it actually comes down into.
+ */
+
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+struct TerrainVertex {
+  int16_t x;  // dm
+  int16_t y;  // dm
+};
+
+// Where an arc meets the ground
+struct TerrainHit {
+  float t;      // Time after the arc start
+  float x;
+  float y;
+  float slope;  // dy/dx of the ground hit
+  bool wall;    // Hit the face of a cliff
+};
+
+class Terrain {
+  public:
+    void begin();
+    
+    float heightAt(float x);
+    float slopeAt(float x);
+    
+    // First contact of y0 + vy·t - g·t²/2 launched from (x0, y0), vx >= 0
+    TerrainHit intersect(float x0, float y0, float vx, float vy, float g);
+    
+    // Distance from x to the next rising cliff, up to limit
+    float clearDistance(float x, float limit);
+    
+    // Vertices, for drawing
+    int getVertexCount() { return vertexCount; }
+    float getVertexX(int i) { return vertices[i].x * 0.1f; }
+    float getVertexY(int i) { return vertices[i].y * 0.1f; }
+    int firstVertexAt(float x);
+    
+  private:
+    const TerrainVertex* vertices;
+    int vertexCount;
+    
+    // Bucket index
+    uint8_t bucketFirst[TERRAIN_MAX_BUCKETS];  // First vertex of a segment reaching into the bucket
+    float bucketMax[TERRAIN_MAX_BUCKETS];
+    int bucketCount;
+    
+    int bucketOf(float x);
+    bool segmentHit(int i, float x0, float y0, float vx, float vy, float g, TerrainHit& hit);
+};
+
+extern Terrain terrain;
+
+#endif
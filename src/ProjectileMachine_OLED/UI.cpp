@@ -5,6 +5,16 @@
 #include "UI.h"
 #include "Config.h"
 #include "Assets.h"
+#include "Profiler.h"
+#include "Latency.h"
+#include "Governor.h"
+#include "Terrain.h"
+#include "Obstacles.h"
+#include "Salvo.h"
+#include "Targeting.h"
+#include "Envelope.h"
+#include "Sweep.h"
+#include "Dispersion.h"
 
 UIRenderer::UIRenderer(Adafruit_SSD1306* disp, PhysicsEngine* phys) {
   display = disp;
@@ -14,9 +24,13 @@ UIRenderer::UIRenderer(Adafruit_SSD1306* disp, PhysicsEngine* phys) {
   cannonMouthY = GROUND_Y - CANNON_LENGTH;
   dottedPathCount = 0;
   bootAnimPhase = 0;
+  qualityLevel = QUALITY_FULL;
+  salvoView = false;
+  sensitivityView = false;
+  flight = NULL;
   
   // Initialize dotted path
-  for (int i = 0; i < MAX_DOTTED_POINTS; i++) {
+  for (int i = 0; i < BUILD.dottedPoints; i++) {
     dottedPath[i].active = false;
   }
 }
@@ -30,6 +44,8 @@ void UIRenderer::begin() {
 void UIRenderer::render(uint8_t state) {
   display->clearDisplay();
   
+  PROFILE_BEGIN(renderStart);
+  salvoView = state == 9;
   switch (state) {
     case 0: // BOOT_ANIM
       renderBootAnimation();
@@ -55,9 +71,33 @@ void UIRenderer::render(uint8_t state) {
     case 7: // RESULTS
       renderResults();
       break;
+    case 8: // LOG_SUMMARY
+      renderLogSummary();
+      break;
+    case 9: // SALVO_RUN
+      renderSimulation();
+      break;
+    case 10: // SALVO_RESULTS
+      renderSalvoResults();
+      break;
+    case 11: // TARGETING
+      renderTargeting();
+      break;
+    case 12: // SWEEP
+      renderSweep();
+      break;
+  }
+  PROFILE_END(renderStart, PROFILE_RENDER_STAGE(state));
+  
+  if (profiler.isOverlayEnabled()) {
+    renderPerfOverlay();
   }
+  latency.frameRendered(micros());
   
+  PROFILE_BEGIN(flushStart);
   display->display();
+  PROFILE_END(flushStart, STAGE_FLUSH);
+  latency.frameFlushed(micros());
 }
 
 void UIRenderer::setHeight(float height) { currentHeight = height; }
@@ -73,40 +113,36 @@ void UIRenderer::setCannonMouthPosition(float angle, float height) {
   cannonMouthX = CANNON_X + CANNON_LENGTH * cos(angleRad);
   cannonMouthY = GROUND_Y - CANNON_LENGTH * sin(angleRad) - height;
 }
-void UIRenderer::setSimulationData(Point ballPos, Point velocity, TrailPoint* trail, int trailLen) {
-  simBallPos = ballPos;
-  simVelocity = velocity;
-  simTrail = trail;
-  simTrailLen = trailLen;
-}
-void UIRenderer::setResults(float maxHeight, float range, float time) {
+void UIRenderer::setResults(float maxHeight, float range, float time, int bounces, int targets) {
   resultMaxHeight = maxHeight;
   resultRange = range;
   resultTime = time;
+  resultBounces = bounces;
+  resultTargets = targets;
 }
 void UIRenderer::setBootAnimationPhase(unsigned int phase) {
   bootAnimPhase = phase;
 }
 
 void UIRenderer::addDottedPathPoint(float x, float y) {
-  if (dottedPathCount < MAX_DOTTED_POINTS) {
+  if (dottedPathCount < BUILD.dottedPoints) {
     dottedPath[dottedPathCount].x = x;
     dottedPath[dottedPathCount].y = y;
     dottedPath[dottedPathCount].active = true;
     dottedPathCount++;
   } else {
     // Shift array to make room
-    for (int i = 0; i < MAX_DOTTED_POINTS - 1; i++) {
+    for (int i = 0; i < BUILD.dottedPoints - 1; i++) {
       dottedPath[i] = dottedPath[i + 1];
     }
-    dottedPath[MAX_DOTTED_POINTS - 1].x = x;
-    dottedPath[MAX_DOTTED_POINTS - 1].y = y;
-    dottedPath[MAX_DOTTED_POINTS - 1].active = true;
+    dottedPath[BUILD.dottedPoints - 1].x = x;
+    dottedPath[BUILD.dottedPoints - 1].y = y;
+    dottedPath[BUILD.dottedPoints - 1].active = true;
   }
 }
 
 void UIRenderer::clearDottedPath() {
-  for (int i = 0; i < MAX_DOTTED_POINTS; i++) {
+  for (int i = 0; i < BUILD.dottedPoints; i++) {
     dottedPath[i].active = false;
   }
   dottedPathCount = 0;
@@ -208,12 +244,14 @@ void UIRenderer::renderMorseInput() {
 void UIRenderer::renderAngleAdjust() {
   // Draw ground
   drawGround(0);
+  drawGhosts(0);
   
   // Draw cannon with current angle
   display->fillRect(CANNON_X - 2, GROUND_Y - 2, 4, 4, SSD1306_WHITE);
   
   // Draw predicted path starting from cannon mouth
   drawPredictedPath(cannonMouthX, cannonMouthY);
+  if (envelope.isEnabled()) drawEnvelope();
   
   // HUD
   char buf[16];
@@ -230,12 +268,14 @@ void UIRenderer::renderAngleAdjust() {
 void UIRenderer::renderVelocityAdjust() {
   // Draw ground
   drawGround(0);
+  drawGhosts(0);
   
   // Draw cannon with current angle
   drawCannon(currentAngle, cannonMouthX, cannonMouthY);
   
   // Draw predicted path starting from cannon mouth
   drawPredictedPath(cannonMouthX, cannonMouthY);
+  if (envelope.isEnabled()) drawEnvelope();
   
   // HUD
   char buf[16];
@@ -250,9 +290,19 @@ void UIRenderer::renderVelocityAdjust() {
 }
 
 void UIRenderer::renderSimulation() {
-  // Update camera to follow ball
-  cameraX = simBallPos.x - SCREEN_WIDTH / 2;
-  if (cameraX < 0) cameraX = 0;
+  // Camera follows the ball, or the lead shot of a salvo
+  float followX = 0;
+  if (salvoView) {
+    for (int i = 0; i < salvo.getCount(); i++) {
+      if (!salvo.isLanded(i) || salvo.isComplete()) followX = max(followX, salvo.getX(i));
+    }
+    cameraX = followX - SCREEN_WIDTH / 2;
+    if (cameraX < 0) cameraX = 0;
+  } else if (flight) {
+    cameraX = flight->cameraX;
+  } else {
+    return;
+  }
   
   // Draw ground with scrolling
   drawGround(cameraX);
@@ -269,8 +319,22 @@ void UIRenderer::renderSimulation() {
                      SSD1306_WHITE);
   }
   
+  // Thinner paths when the governor is shedding detail
+  int pathStride = qualityLevel >= QUALITY_THIN_PATHS ? 4 : 2;
+  int trailStride = qualityLevel >= QUALITY_THIN_PATHS ? 2 : 1;
+  
+  if (salvoView) {
+    drawSalvo(trailStride);
+    char buf[16];
+    dtostrf(followX, 5, 1, buf);
+    drawHUD("X:", buf);
+    return;
+  }
+  
+  drawGhosts(cameraX);
+  
   // Draw dotted path - starting from CANNON_X position
-  for (int i = 0; i < dottedPathCount; i += 2) { // Draw every other point
+  for (int i = 0; i < dottedPathCount; i += pathStride) {
     if (dottedPath[i].active) {
       // Add CANNON_X offset to make path start from cannon
       int screenX = CANNON_X + dottedPath[i].x - cameraX;
@@ -283,13 +347,14 @@ void UIRenderer::renderSimulation() {
   }
   
   // Draw trail - starting from CANNON_X position
-  for (int i = 0; i < simTrailLen; i++) {
-    if (simTrail[i].age < 255) {
-      int alpha = 255 - simTrail[i].age * 20;
+  for (int i = 0; i < flight->trailLength; i += trailStride) {
+    const TrailPoint& p = flight->trail[i];
+    if (p.age < 255) {
+      int alpha = 255 - p.age * 20;
       if (alpha > 30) {
         // Add CANNON_X offset to make trail start from cannon
-        int x = CANNON_X + simTrail[i].x - cameraX;
-        int y = GROUND_Y - simTrail[i].y;
+        int x = CANNON_X + p.x - cameraX;
+        int y = GROUND_Y - p.y;
         if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
           display->drawPixel(x, y, SSD1306_WHITE);
         }
@@ -299,20 +364,119 @@ void UIRenderer::renderSimulation() {
   
   // Draw ball - starting from CANNON_X position
   // This is the key fix: Add CANNON_X offset to the ball's position
-  int ballX = CANNON_X + simBallPos.x - cameraX;
-  int ballY = GROUND_Y - simBallPos.y;
+  int ballX = CANNON_X + flight->position.x - cameraX;
+  int ballY = GROUND_Y - flight->position.y;
   display->fillCircle(ballX, ballY, BALL_RADIUS, SSD1306_WHITE);
   
   // Draw velocity vectors attached to ball
-  drawVelocityVectors(ballX, ballY, simVelocity.x, simVelocity.y);
+  if (qualityLevel < QUALITY_NO_VECTORS) {
+    drawVelocityVectors(ballX, ballY, flight->velocity.x, flight->velocity.y);
+  }
   
   // Draw HUD with time
   char buf[16];
-  dtostrf(simBallPos.x, 5, 1, buf);
+  dtostrf(flight->position.x, 5, 1, buf);
   drawHUD("X:", buf);
 }
 
+void UIRenderer::drawSalvo(int trailStride) {
+  for (int i = 0; i < salvo.getCount(); i++) {
+    // Trail, fading out by skipping the oldest points
+    for (int p = 0; p < salvo.getTrailLength(); p += trailStride) {
+      int x = CANNON_X + salvo.getTrailX(i, p) - cameraX;
+      int y = GROUND_Y - salvo.getTrailY(i, p);
+      if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
+        display->drawPixel(x, y, SSD1306_WHITE);
+      }
+    }
+    
+    // Landed shots are drawn hollow
+    int ballX = CANNON_X + salvo.getX(i) - cameraX;
+    int ballY = GROUND_Y - salvo.getY(i);
+    if (salvo.isLanded(i)) {
+      display->drawCircle(ballX, ballY, BALL_RADIUS, SSD1306_WHITE);
+    } else {
+      display->fillCircle(ballX, ballY, BALL_RADIUS, SSD1306_WHITE);
+    }
+  }
+}
+
+void UIRenderer::renderSalvoResults() {
+  static const char MODE_LABELS[] = {'A', 'V', 'G'};
+  
+  display->setCursor(34, 0);
+  display->print(F("SALVO"));
+  display->print(' ');
+  display->print(MODE_LABELS[salvo.getMode()]);
+  
+  // One row per shot: launch value, range, flight time
+  for (int i = 0; i < salvo.getCount() && i < 5; i++) {
+    int y = 10 + i * 9;
+    ShotResult result = salvo.getResult(i);
+    display->setCursor(0, y);
+    display->print(salvo.getParameter(i), 1);
+    display->setCursor(34, y);
+    display->print(F("R"));
+    display->print(result.range, 1);
+    display->setCursor(88, y);
+    display->print(F("T"));
+    display->print(result.flightTime, 1);
+  }
+  
+  display->setCursor(0, 56);
+  display->print(F("ENTER:back DOWN:mode"));
+}
+
+void UIRenderer::renderTargeting() {
+  drawGround(0);
+  display->fillRect(CANNON_X - 2, GROUND_Y - 2, 4, 4, SSD1306_WHITE);
+  
+  // Both solutions side by side, the high one more sparsely dotted
+  int stride = qualityLevel >= QUALITY_THIN_PATHS ? 4 : 2;
+  drawPath(&targeting.lowPath, stride);
+  drawPath(&targeting.highPath, stride * 2);
+  
+  // Target flag, or an arrow at the edge when it is off screen
+  int targetX = CANNON_X + targeting.getDistance();
+  int targetY = GROUND_Y - targeting.getHeight();
+  if (targetX < SCREEN_WIDTH) {
+    display->drawLine(targetX, targetY, targetX, targetY - 8, SSD1306_WHITE);
+    display->fillTriangle(targetX, targetY - 8, targetX, targetY - 4, targetX + 4, targetY - 6, SSD1306_WHITE);
+  } else {
+    display->fillTriangle(SCREEN_WIDTH - 1, 30, SCREEN_WIDTH - 5, 27, SCREEN_WIDTH - 5, 33, SSD1306_WHITE);
+  }
+  
+  display->setCursor(0, 0);
+  display->print(F("Target "));
+  display->print(targeting.getDistance(), 1);
+  display->print(F("m"));
+  
+  // Low angle, high angle, minimum velocity; the chosen one inverted
+  TargetSolution solution = targeting.getSolution();
+  const char labels[] = {'L', 'H', 'V'};
+  float values[] = {solution.lowAngle, solution.highAngle, solution.minVelocity};
+  display->setCursor(0, 8);
+  for (int i = 0; i < TARGET_CHOICES; i++) {
+    if (i == targeting.getChoice()) {
+      display->setTextColor(SSD1306_BLACK, SSD1306_WHITE);
+    }
+    display->print(labels[i]);
+    if (i == TARGET_MIN_VELOCITY || solution.reachable) {
+      display->print(values[i], 1);
+    } else {
+      display->print(F("--"));
+    }
+    display->setTextColor(SSD1306_WHITE);
+    display->print(' ');
+  }
+}
+
 void UIRenderer::renderResults() {
+  if (sensitivityView) {
+    renderSensitivities();
+    return;
+  }
+  
   display->setCursor(40, 5);
   display->print(F("RESULTS"));
   
@@ -334,8 +498,198 @@ void UIRenderer::renderResults() {
   display->print(resultTime, 1);
   display->print(F("s"));
   
+  if (resultBounces > 0) {
+    display->setCursor(104, 40);
+    display->print(F("B"));
+    display->print(resultBounces);
+  }
+  
+  if (resultTargets > 0) {
+    display->setCursor(104, 30);
+    display->print(F("T"));
+    display->print(resultTargets);
+  }
+  
+  drawDispersion();
+  
+  display->setCursor(10, 55);
+  display->print(F("ENTER:restart UP:log"));
+}
+
+void UIRenderer::renderSensitivities() {
+  // How far each result moves for one degree or one m/s of dialling
+  display->setCursor(0, 5);
+  display->print(F("+- per"));
+  display->setCursor(46, 5);
+  display->print(F("deg"));
+  display->setCursor(88, 5);
+  display->print(F("m/s"));
+  
+  drawSensitivityRow(20, F("Range"), sensitivity.range);
+  drawSensitivityRow(30, F("Max H"), sensitivity.maxHeight);
+  drawSensitivityRow(40, F("Time"), sensitivity.flightTime);
+  
   display->setCursor(10, 55);
-  display->print(F("ENTER:restart"));
+  display->print(F("ENTER:restart UP:log"));
+}
+
+void UIRenderer::drawSensitivityRow(int y, const __FlashStringHelper* label, const Sensitive& value) {
+  display->setCursor(0, y);
+  display->print(label);
+  display->setCursor(40, y);
+  display->print(F("+-"));
+  display->print(fabs(value.d[SENS_ANGLE]), 2);
+  display->setCursor(82, y);
+  display->print(F("+-"));
+  display->print(fabs(value.d[SENS_VELOCITY]), 2);
+}
+
+void UIRenderer::drawDispersion() {
+  // Dot plot of perturbed landings around their mean, filling in as
+  // they are flown; ticks at one sigma either side
+  int count = dispersion.getCount();
+  if (count < 2) return;
+  
+  const int baseY = 54;
+  const int halfWidth = 60;
+  float mean = dispersion.getMean();
+  float extent = 0.5f;
+  for (int i = 0; i < count; i++) {
+    extent = max(extent, fabs(dispersion.getImpact(i) - mean));
+  }
+  float scale = halfWidth / extent;
+  
+  uint8_t stacks[2 * halfWidth + 1] = {0};
+  for (int i = 0; i < count; i++) {
+    int column = constrain((int)((dispersion.getImpact(i) - mean) * scale) + halfWidth, 0, 2 * halfWidth);
+    if (stacks[column] < 5) {
+      display->drawPixel(SCREEN_WIDTH / 2 - halfWidth + column, baseY - 1 - stacks[column], SSD1306_WHITE);
+      stacks[column]++;
+    }
+  }
+  
+  int sigma = dispersion.getSigma() * scale;
+  display->drawFastHLine(SCREEN_WIDTH / 2 - halfWidth, baseY, 2 * halfWidth + 1, SSD1306_WHITE);
+  display->drawFastVLine(SCREEN_WIDTH / 2, baseY - 2, 2, SSD1306_WHITE);
+  display->drawFastVLine(SCREEN_WIDTH / 2 - sigma, baseY - 3, 3, SSD1306_WHITE);
+  display->drawFastVLine(SCREEN_WIDTH / 2 + sigma, baseY - 3, 3, SSD1306_WHITE);
+  
+  display->setCursor(96, 5);
+  display->print(F("+-"));
+  display->print(dispersion.getSigma(), 1);
+}
+
+void UIRenderer::renderLogSummary() {
+  display->setCursor(40, 5);
+  display->print(F("SHOT LOG"));
+  
+  display->setCursor(10, 16);
+  display->print(F("Shots:"));
+  display->setCursor(70, 16);
+  display->print(logSummary.count);
+  
+  display->setCursor(10, 25);
+  display->print(F("Best:"));
+  display->setCursor(70, 25);
+  display->print(logSummary.bestRange, 1);
+  display->print(F("m"));
+  
+  display->setCursor(10, 34);
+  display->print(F("Avg R:"));
+  display->setCursor(70, 34);
+  display->print(logSummary.avgRange, 1);
+  display->print(F("m"));
+  
+  display->setCursor(10, 43);
+  display->print(F("Avg H:"));
+  display->setCursor(70, 43);
+  display->print(logSummary.avgMaxHeight, 1);
+  display->print(F("m"));
+  
+  display->setCursor(10, 55);
+  display->print(F("ENTER:back"));
+}
+
+void UIRenderer::renderSweep() {
+  // Heatmap on the right: angle across, velocity up, darker is less
+  const int mapX = SCREEN_WIDTH - SWEEP_ANGLE_CELLS * SWEEP_CELL_PX;
+  const int mapY = 8;
+  uint16_t maxValue = sweep.getMaxValue();
+  for (int row = 0; row < SWEEP_VELOCITY_CELLS; row++) {
+    int cellY = mapY + (SWEEP_VELOCITY_CELLS - 1 - row) * SWEEP_CELL_PX;
+    for (int column = 0; column < SWEEP_ANGLE_CELLS; column++) {
+      if (!sweep.isDone(column, row)) continue;
+      int cellX = mapX + column * SWEEP_CELL_PX;
+      uint8_t level = (uint32_t)sweep.getValue(column, row) * 16 / (maxValue + 1);
+      for (int py = 0; py < SWEEP_CELL_PX; py++) {
+        for (int px = 0; px < SWEEP_CELL_PX; px++) {
+          if (level > BAYER_4X4[(cellY + py) & 3][(cellX + px) & 3]) {
+            display->drawPixel(cellX + px, cellY + py, SSD1306_WHITE);
+          }
+        }
+      }
+    }
+  }
+  display->drawRect(mapX - 1, mapY - 1, SWEEP_ANGLE_CELLS * SWEEP_CELL_PX + 1,
+                    SWEEP_VELOCITY_CELLS * SWEEP_CELL_PX + 2, SSD1306_WHITE);
+  
+  // Current shot
+  int column = constrain((int)((currentAngle - MIN_ANGLE) * SWEEP_ANGLE_CELLS / (MAX_ANGLE - MIN_ANGLE)),
+                         0, SWEEP_ANGLE_CELLS - 1);
+  int row = constrain((int)((currentVelocity - MIN_VELOCITY) * SWEEP_VELOCITY_CELLS / (MAX_VELOCITY - MIN_VELOCITY)),
+                      0, SWEEP_VELOCITY_CELLS - 1);
+  int markX = mapX + column * SWEEP_CELL_PX;
+  int markY = mapY + (SWEEP_VELOCITY_CELLS - 1 - row) * SWEEP_CELL_PX;
+  display->drawRect(markX - 1, markY - 1, SWEEP_CELL_PX + 2, SWEEP_CELL_PX + 2, SSD1306_INVERSE);
+  
+  // Metric, scale and progress on the left
+  static const char* const names[] = {"Range", "Apex", "Time"};
+  char unit = sweep.getMetric() == SWEEP_TIME ? 's' : 'm';
+  display->setCursor(0, 0);
+  display->print(names[sweep.getMetric()]);
+  display->setCursor(0, 12);
+  display->print(maxValue / SWEEP_SCALE);
+  display->print(unit);
+  if (sweep.isDone(column, row)) {
+    display->setCursor(0, 28);
+    display->print(F(">"));
+    display->print((float)sweep.getValue(column, row) / SWEEP_SCALE, 0);
+    display->print(unit);
+  }
+  if (!sweep.isComplete()) {
+    display->setCursor(0, 44);
+    display->print(sweep.getDone() * 100 / SWEEP_CELLS);
+    display->print(F("%"));
+  }
+  
+  display->setCursor(mapX - 6, 57);
+  display->print((int)MIN_ANGLE);
+  display->setCursor(SCREEN_WIDTH - 12, 57);
+  display->print((int)MAX_ANGLE);
+}
+
+void UIRenderer::renderPerfOverlay() {
+  // Boxed panel in the top-left corner over whatever the state drew
+  int lines = 1 + PERF_OVERLAY_TOP_STAGES;
+  display->fillRect(0, 0, 66, lines * 8 + 2, SSD1306_BLACK);
+  display->drawRect(0, 0, 66, lines * 8 + 2, SSD1306_WHITE);
+  
+  display->setCursor(2, 1);
+  display->print(profiler.getFps());
+  display->print(F("fps "));
+  display->print(profiler.getFrameMs(), 1);
+  display->print(F("ms"));
+  
+  uint8_t top[PERF_OVERLAY_TOP_STAGES];
+  uint8_t count = profiler.getTopStages(top, PERF_OVERLAY_TOP_STAGES);
+  char name[8];
+  for (uint8_t i = 0; i < count; i++) {
+    profiler.getStageName(top[i], name);
+    display->setCursor(2, 9 + i * 8);
+    display->print(name);
+    display->setCursor(32, 9 + i * 8);
+    display->print(profiler.getAverageMs(top[i]), 2);
+  }
 }
 
 void UIRenderer::drawCannon(float angle, float mouthX, float mouthY) {
@@ -361,27 +715,161 @@ void UIRenderer::drawCannon(float angle, float mouthX, float mouthY) {
 }
 
 void UIRenderer::drawGround(float offsetX) {
-  int groundY = GROUND_Y;
+  // World x at the screen edges; 1 m per pixel
+  float left = offsetX - CANNON_X;
+  float right = left + SCREEN_WIDTH;
+  
+  // Ground profile: the vertices in view joined up, cliffs included
+  int prevX = 0;
+  int prevY = GROUND_Y - terrain.heightAt(left);
+  int count = terrain.getVertexCount();
+  for (int i = terrain.firstVertexAt(max(left, 0.0f)); i < count; i++) {
+    float vertexX = terrain.getVertexX(i);
+    if (vertexX <= left) continue;
+    if (vertexX >= right) break;
+    
+    int x = vertexX - left;
+    int y = GROUND_Y - terrain.getVertexY(i);
+    display->drawLine(prevX, prevY, x, y, SSD1306_WHITE);
+    prevX = x;
+    prevY = y;
+  }
+  display->drawLine(prevX, prevY, SCREEN_WIDTH, GROUND_Y - terrain.heightAt(right), SSD1306_WHITE);
   
-  // Draw ground line
-  display->drawLine(0, groundY, SCREEN_WIDTH, groundY, SSD1306_WHITE);
+  drawObstacles(left);
+  
+  if (qualityLevel >= QUALITY_NO_TEXTURE) return;
   
   // Draw ground texture (dots)
   for (int x = ((int)offsetX % 8); x < SCREEN_WIDTH; x += 8) {
-    display->drawPixel(x, groundY + 1, SSD1306_WHITE);
-    display->drawPixel(x + 4, groundY + 2, SSD1306_WHITE);
+    display->drawPixel(x, GROUND_Y - terrain.heightAt(left + x) + 1, SSD1306_WHITE);
+    display->drawPixel(x + 4, GROUND_Y - terrain.heightAt(left + x + 4) + 2, SSD1306_WHITE);
+  }
+}
+
+void UIRenderer::drawObstacles(float left) {
+  // Obstacles solid; targets outlined until the flight passes through
+  uint32_t hits = flight ? flight->targetMask : 0;
+  for (int i = 0; i < obstacles.getCount(); i++) {
+    const Obstacle& o = obstacles.get(i);
+    if (o.x1 < left || o.x0 > left + SCREEN_WIDTH) continue;
+    
+    int x = o.x0 - left;
+    int y = GROUND_Y - o.y1;
+    int w = max(1, (int)(o.x1 - o.x0 + 0.5f));
+    int h = max(1, (int)(o.y1 - o.y0 + 0.5f));
+    bool filled = !obstacles.isTarget(i) || ((hits >> i) & 1);
+    if (o.shape == SHAPE_CIRCLE) {
+      int r = w / 2;
+      if (filled) display->fillCircle(x + r, y + r, r, SSD1306_WHITE);
+      else display->drawCircle(x + r, y + r, r, SSD1306_WHITE);
+    } else if (filled) {
+      display->fillRect(x, y, w, h, SSD1306_WHITE);
+    } else {
+      display->drawRect(x, y, w, h, SSD1306_WHITE);
+    }
   }
 }
 
 void UIRenderer::drawPredictedPath(float startX, float startY) {
-  // Get prediction points from physics engine
-  Point* prediction = physics->getPrediction();
-  int points = physics->getPredictionPoints();
+  // Draw predicted path as dots starting from cannon mouth
+  int stride = qualityLevel >= QUALITY_THIN_PATHS ? 4 : 2; // Dotted effect
+  drawPath(physics, stride);
+}
+
+void UIRenderer::drawEnvelope() {
+  // Dashed envelope out to the farthest landing, marked with a tick
+  float range = envelope.getMaxRange();
+  int end = min(CANNON_X + (int)range, SCREEN_WIDTH - 1);
+  int prevY = constrain(GROUND_Y - (int)envelope.getApex(), -1, SCREEN_HEIGHT);
+  for (int x = CANNON_X; x <= end; x++) {
+    int y = constrain(GROUND_Y - (int)envelope.heightAt(x - CANNON_X), -1, SCREEN_HEIGHT);
+    if ((x - CANNON_X) % ENVELOPE_DASH < ENVELOPE_DASH / 2) {
+      display->drawLine(x - 1, prevY, x, y, SSD1306_WHITE);
+    }
+    prevY = y;
+  }
+  if (CANNON_X + range < SCREEN_WIDTH) {
+    display->drawFastVLine(CANNON_X + range, GROUND_Y - envelope.getMaxRangeHeight() - 4, 3, SSD1306_WHITE);
+  }
+  
+  // Reach and best angle under the HUD
+  display->setCursor(SCREEN_WIDTH - 50, 16);
+  display->print(F("Max"));
+  display->print(range, 0);
+  display->print(F("m"));
+  display->setCursor(SCREEN_WIDTH - 50, 24);
+  display->print(F("Opt"));
+  display->print(envelope.getOptimalAngle(), 1);
+  if (!SafetyEnvelope::isUpperBound()) {
+    display->setCursor(SCREEN_WIDTH - 50, 32);
+    display->print(F("vacuum"));
+  }
+}
+
+void UIRenderer::drawGhosts(float camera) {
+  // Only the newest once the governor thins paths, none without texture
+  if (qualityLevel >= QUALITY_NO_TEXTURE) return;
+  int count = qualityLevel >= QUALITY_THIN_PATHS ? min(ghosts.getCount(), 1) : ghosts.getCount();
+  for (int i = 0; i < count; i++) {
+    drawGhost(ghosts.get(i), camera - CANNON_X);
+  }
+}
+
+void UIRenderer::drawGhost(const GhostArc& arc, float left) {
+  float h = arc.height * 0.01f;
+  float vx = arc.vx * 0.01f;
+  float vy = arc.vy * 0.01f;
+  float g = arc.gravity * 0.001f;
+  float reach = vx * arc.endTime * 0.01f;
+  
+  // Under a pixel of reach: a dashed post from the muzzle to the apex
+  if (reach < 1) {
+    int x = -left;
+    if (x < 0 || x >= SCREEN_WIDTH) return;
+    float apex = vy > 0 ? h + vy * vy / (2 * g) : h;
+    int top = max(GROUND_Y - (int)apex, 0);
+    for (int y = min(GROUND_Y - (int)h, SCREEN_HEIGHT - 1); y >= top; y--) {
+      if (y % GHOST_DASH < GHOST_DASH / 3) display->drawPixel(x, y, SSD1306_WHITE);
+    }
+    return;
+  }
+  
+  // Screen columns between the muzzle and where the arc ended
+  int first = max((int)ceilf(-left), 0);
+  int last = min((int)(reach - left), SCREEN_WIDTH - 1);
+  if (first > last) return;
+  
+  // y(x) = h + b·x + a·x², stepped one column at a time by forward
+  // differences in 32.32 fixed point: two integer adds per column
+  const float ONE = 4294967296.0f;
+  float a = -g / (2 * vx * vx);
+  float b = vy / vx;
+  float x = first + left;
+  int64_t y = (int64_t)((h + (b + a * x) * x) * ONE);
+  int64_t dy = (int64_t)((b + a * (2 * x + 1)) * ONE);
+  int64_t ddy = (int64_t)(2 * a * ONE);
+  
+  // Dashes keep to world columns, so they do not crawl as the camera pans
+  int phase = ((int)floorf(left) + first) % GHOST_DASH;
+  for (int column = first; column <= last; column++) {
+    if (phase < GHOST_DASH / 3) {
+      int screenY = GROUND_Y - (int)(y >> 32);
+      if (screenY >= 0 && screenY < SCREEN_HEIGHT) display->drawPixel(column, screenY, SSD1306_WHITE);
+    }
+    if (++phase == GHOST_DASH) phase = 0;
+    y += dy;
+    dy += ddy;
+  }
+}
+
+void UIRenderer::drawPath(PhysicsEngine* engine, int stride) {
+  Point* prediction = engine->getPrediction();
+  int points = engine->getPredictionPoints();
   
   if (points < 2) return;
   
-  // Draw predicted path as dots starting from cannon mouth
-  for (int i = 0; i < points; i += 2) { // Draw every other point for dotted effect
+  for (int i = 0; i < points; i += stride) {
     // Add CANNON_X offset to start from cannon mouth
     int screenX = CANNON_X + prediction[i].x;
     int screenY = GROUND_Y - prediction[i].y;
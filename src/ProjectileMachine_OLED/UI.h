@@ -7,7 +7,10 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "Ghosts.h"
 #include "Physics.h"
+#include "ResultsLog.h"
+#include "Snapshot.h"
 
 struct DottedPoint {
   float x;
@@ -28,12 +31,21 @@ class UIRenderer {
     void setAngle(float angle);
     void setVelocity(float velocity);
     void setCannonMouthPosition(float angle, float height);
-    void setSimulationData(Point ballPos, Point velocity, TrailPoint* trail, int trailLen);
-    void setResults(float maxHeight, float range, float time);
+    // Flight to draw; the slot stays valid until the next acquire
+    void setSimulationData(const FlightSnapshot* snapshot) { flight = snapshot; }
+    void setResults(float maxHeight, float range, float time, int bounces, int targets);
+    void setLogSummary(const LogSummary& summary) { logSummary = summary; }
+    void setSensitivities(const ShotSensitivity& s) { sensitivity = s; }
+    
+    // Results screen shows the sensitivities instead of the values
+    void setSensitivityView(bool on) { sensitivityView = on; }
     
     // Animation
     void setBootAnimationPhase(unsigned int phase);
     
+    // Detail level chosen by the quality governor
+    void setQualityLevel(uint8_t level) { qualityLevel = level; }
+    
     // Dotted path
     void addDottedPathPoint(float x, float y);
     void clearDottedPath();
@@ -49,20 +61,22 @@ class UIRenderer {
     const char* morseSequence;
     float currentAngle;
     float currentVelocity;
-    Point simBallPos;
-    Point simVelocity;
-    TrailPoint* simTrail;
-    int simTrailLen;
+    const FlightSnapshot* flight;
     float resultMaxHeight;
     float resultRange;
     float resultTime;
+    int resultBounces;
+    int resultTargets;
+    ShotSensitivity sensitivity;
+    bool sensitivityView;
+    LogSummary logSummary;
     
     // Cannon mouth position
     float cannonMouthX;
     float cannonMouthY;
     
     // Dotted path
-    DottedPoint dottedPath[MAX_DOTTED_POINTS];
+    DottedPoint dottedPath[BUILD.dottedPoints];
     int dottedPathCount;
     
     // Camera
@@ -71,6 +85,12 @@ class UIRenderer {
     // Boot animation
     unsigned int bootAnimPhase;
     
+    // Quality level (see Governor.h)
+    uint8_t qualityLevel;
+    
+    // Simulation screen shows the salvo instead of the single shot
+    bool salvoView;
+    
     // Rendering methods
     void renderBootAnimation();
     void renderHeightSelect();
@@ -80,12 +100,26 @@ class UIRenderer {
     void renderVelocityAdjust();
     void renderSimulation();
     void renderResults();
+    void renderSensitivities();
+    void renderLogSummary();
+    void renderSalvoResults();
+    void renderTargeting();
+    void renderSweep();
+    void renderPerfOverlay();
     
     // Helper methods
     void drawCannon(float angle, float mouthX, float mouthY);
     void drawGround(float offsetX);
+    void drawObstacles(float left);
     void drawPredictedPath(float startX, float startY);
+    void drawPath(PhysicsEngine* engine, int stride);
+    void drawEnvelope();
+    void drawGhosts(float camera);
+    void drawGhost(const GhostArc& arc, float left);
     void drawDottedPath();
+    void drawSalvo(int trailStride);
+    void drawDispersion();
+    void drawSensitivityRow(int y, const __FlashStringHelper* label, const Sensitive& value);
     void drawVelocityVectors(float x, float y, float vx, float vy);
     void drawHUD(const char* line1, const char* line2 = "");
     int worldToScreenX(float worldX);
@@ -97,4 +131,22 @@ class UIRenderer {
     void drawStars(int count);
 };
 
+// Path buffers of a profile: the prediction, the engine's trail and step
+// history plus one of each per snapshot slot, the flown path markers and
+// the ghost arcs
+constexpr uint32_t profileRamBytes(const BuildProfile& p) {
+  return p.predictionPoints * sizeof(Point) + p.trailPoints * sizeof(TrailPoint) * 4 +
+         p.stepHistory * sizeof(StepRecord) * 4 +
+         p.dottedPoints * sizeof(DottedPoint) + p.ghostShots * sizeof(GhostArc);
+}
+
+constexpr bool profileFits(const BuildProfile& p) {
+  return profileRamBytes(p) <= p.ramBudget && profileFrameCostUs(p) <= p.frameTimeMs * 1000UL;
+}
+
+static_assert(profileFits(PROFILES[BUILD_BALANCED]), "balanced profile is over its RAM or frame budget");
+static_assert(profileFits(PROFILES[BUILD_LOW_RAM]), "low-ram profile is over its RAM or frame budget");
+static_assert(profileFits(PROFILES[BUILD_HIGH_FPS]), "high-fps profile is over its RAM or frame budget");
+static_assert(profileFits(PROFILES[BUILD_PRECISION]), "precision profile is over its RAM or frame budget");
+
 #endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Cross-check the firmware's batch-solve mode against a reference solver.
+
+Generates a seeded table of (height, gravity, angle, velocity) launches,
+streams it through the 'batch' Serial mode and compares every reply with
+a double-precision closed-form solution. The link is either a serial
+port or any program that speaks the same protocol on stdin/stdout,
+such as a host build of the sketch.
+
+  batch_check.py --port /dev/ttyUSB0 -n 20000
+  batch_check.py --exec ./replay --batch -n 1000000
+
+Replies can also be saved with --table to build parameter tables.
+"""
+
+import argparse
+import math
+import random
+import subprocess
+import sys
+import time
+
+
+def reference(h0, g, angle_deg, v0):
+    a = math.radians(angle_deg)
+    vx, vy = v0 * math.cos(a), v0 * math.sin(a)
+    apex = h0 + vy * vy / (2 * g) if vy > 0 else h0
+    t = (vy + math.sqrt(vy * vy + 2 * g * h0)) / g
+    return vx * t, apex, t
+
+
+def make_rows(n, seed):
+    rng = random.Random(seed)
+    for _ in range(n):
+        yield (round(rng.uniform(0, 50), 1), round(rng.uniform(0.1, 20), 2),
+               round(rng.uniform(0, 90), 1), round(rng.uniform(1, 50), 1))
+
+
+class SerialLink:
+    def __init__(self, port, baud):
+        import serial
+        self.port = serial.Serial(port, baud, timeout=5)
+        self.port.reset_input_buffer()
+
+    def write(self, data):
+        self.port.write(data)
+
+    def readline(self):
+        return self.port.readline().decode(errors="replace").strip()
+
+
+class ProcessLink:
+    def __init__(self, argv):
+        self.proc = subprocess.Popen(argv, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+    def write(self, data):
+        self.proc.stdin.write(data)
+        self.proc.stdin.flush()
+
+    def readline(self):
+        return self.proc.stdout.readline().decode(errors="replace").strip()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    link_group = parser.add_mutually_exclusive_group(required=True)
+    link_group.add_argument("--port", help="serial port of the device")
+    link_group.add_argument("--exec", nargs=argparse.REMAINDER, dest="argv",
+                            help="program to run as the link (rest of the command line)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("-n", "--rows", type=int, default=10000)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--rel-tol", type=float, default=2e-4)
+    parser.add_argument("--window", type=int, default=32,
+                        help="requests kept in flight to keep the link busy")
+    parser.add_argument("--table", help="write inputs and replies to this CSV")
+    args = parser.parse_args()
+
+    link = SerialLink(args.port, args.baud) if args.port else ProcessLink(args.argv)
+    link.write(b"batch\n")
+    while not link.readline().endswith("OK batch"):
+        pass
+
+    rows = list(make_rows(args.rows, args.seed))
+    table = open(args.table, "w") if args.table else None
+    if table:
+        table.write("h0,g,angle,v0,range,max_height,flight_time\n")
+
+    mismatches = 0
+    worst = 0.0
+    sent = 0
+    start = time.monotonic()
+    for i, row in enumerate(rows):
+        # Keep a window of requests in flight so the link never idles
+        while sent < len(rows) and sent - i < args.window:
+            link.write(("%g %g %g %g\n" % rows[sent]).encode())
+            sent += 1
+
+        reply = link.readline().split()
+        if len(reply) != 3:
+            print(f"row {i}: bad reply {reply}", file=sys.stderr)
+            mismatches += 1
+            continue
+
+        got = [float(v) for v in reply]
+        want = reference(*row)
+        for g, w in zip(got, want):
+            err = abs(g - w) / max(1.0, abs(w))
+            worst = max(worst, err)
+            if err > args.rel_tol:
+                mismatches += 1
+                print(f"row {i} {row}: got {got} want {want}", file=sys.stderr)
+                break
+
+        if table:
+            table.write(",".join(str(v) for v in row + tuple(got)) + "\n")
+
+    elapsed = time.monotonic() - start
+    link.write(b"end\n")
+    print(f"{len(rows)} rows in {elapsed:.2f}s ({len(rows) / elapsed:.0f}/s), "
+          f"{mismatches} mismatches, worst relative error {worst:.2e}")
+    sys.exit(1 if mismatches else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+Decoder for the ProjectileMachine_OLED binary telemetry stream.
+
+Reads COBS-framed records (see src/ProjectileMachine_OLED/Telemetry.h)
+from a capture file or a serial port and writes one column-oriented
+file per record type: ticks, launches and results. Output is CSV by
+default, or Parquet when --parquet is given and pyarrow is installed.
+
+  telemetry_decode.py capture.bin -o flight
+  telemetry_decode.py --port /dev/ttyUSB0 --baud 115200 -o flight
+
+Text lines that share the port (state changes, console replies) are
+skipped: they never pass the CRC check.
+
+Every physics step of a flight is sent as a tick numbered from 1, so
+the ticks after each launch record must count up without gaps. With
+--check the exit status is 1 if any are missing.
+"""
+
+import argparse
+import struct
+import sys
+
+RECORDS = {
+    1: ("ticks", "<IffffBH", ["tick", "x", "y", "vx", "vy", "state", "frame_us"]),
+    2: ("launches", "<ffff", ["h0", "g", "angle_deg", "v0"]),
+    3: ("results", "<fff", ["range", "max_height", "flight_time"]),
+}
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self):
+        self.columns = {name: {col: [] for col in cols} | {"seq": []}
+                        for name, _, cols in RECORDS.values()}
+        self.buffer = bytearray()
+        self.frames = 0
+        self.bad_frames = 0
+        self.lost = 0
+        self.last_seq = None
+        self.last_tick = None
+        self.missing_ticks = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            end = self.buffer.find(0)
+            if end < 0:
+                return
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if frame:
+                self._frame(frame)
+
+    def _frame(self, frame):
+        payload = cobs_decode(frame)
+        if payload is None or len(payload) < 4:
+            self.bad_frames += 1
+            return
+        body, crc = payload[:-2], struct.unpack("<H", payload[-2:])[0]
+        if crc16_ccitt(body) != crc or body[0] not in RECORDS:
+            self.bad_frames += 1
+            return
+
+        name, fmt, cols = RECORDS[body[0]]
+        if len(body) - 2 != struct.calcsize(fmt):
+            self.bad_frames += 1
+            return
+
+        seq = body[1]
+        if self.last_seq is not None:
+            self.lost += (seq - self.last_seq - 1) & 0xFF
+        self.last_seq = seq
+
+        if name == "launches":
+            self.last_tick = 0
+        elif name == "ticks":
+            tick = struct.unpack_from("<I", body, 2)[0]
+            if self.last_tick is not None and tick > self.last_tick + 1:
+                self.missing_ticks += tick - self.last_tick - 1
+            self.last_tick = tick
+
+        table = self.columns[name]
+        table["seq"].append(seq)
+        for col, value in zip(cols, struct.unpack(fmt, body[2:])):
+            table[col].append(value)
+        self.frames += 1
+
+
+def write_csv(path, table):
+    cols = list(table)
+    with open(path, "w") as f:
+        f.write(",".join(cols) + "\n")
+        for row in zip(*(table[c] for c in cols)):
+            f.write(",".join(f"{v:.6g}" if isinstance(v, float) else str(v) for v in row) + "\n")
+
+
+def write_parquet(path, table):
+    import pyarrow as pa
+    import pyarrow.parquet as pq
+    pq.write_table(pa.table(table), path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("--port", help="read live from this serial port (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("-o", "--output", default="telemetry", help="output file prefix")
+    parser.add_argument("--parquet", action="store_true", help="write .parquet instead of .csv")
+    parser.add_argument("--check", action="store_true", help="fail if a flight's ticks have gaps")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.5) as port:
+            port.write(b"telem on\n")
+            try:
+                while True:
+                    decoder.feed(port.read(4096))
+            except KeyboardInterrupt:
+                port.write(b"telem off\n")
+    else:
+        stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+        with stream:
+            while chunk := stream.read(65536):
+                decoder.feed(chunk)
+
+    for name, table in decoder.columns.items():
+        if not table["seq"]:
+            continue
+        if args.parquet:
+            write_parquet(f"{args.output}_{name}.parquet", table)
+        else:
+            write_csv(f"{args.output}_{name}.csv", table)
+
+    print(f"{decoder.frames} frames, {decoder.bad_frames} rejected, {decoder.lost} lost, "
+          f"{decoder.missing_ticks} ticks missing", file=sys.stderr)
+    if args.check and decoder.missing_ticks:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()